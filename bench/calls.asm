@@ -0,0 +1,40 @@
+# Call-heavy code: 1.2 million times, a CALL to a routine that saves $ra
+# and calls a leaf twice, then a CSI through the leaf's address in data
+# Data words: 0 = calls left in this round, 1 = leaf calls made,
+# 2 = the leaf's address, 3 = rounds left, 4 = calls per round, 5 = rounds
+	.text start
+start:	LIT $gp, 2, 24         # leaf's address
+round:	CPW $gp, 0, $gp, 4
+loop:	CALL middle
+	CSI $gp, 2
+	ADDI $gp, 0, -1
+	BGTZ $gp, 0, -3        # to loop
+	ADDI $gp, 3, -1
+	BGTZ $gp, 3, -6        # to round
+	SRI $sp, 1             # there should have been 3 * 60000 * 20 leaf calls
+	LIT $sp, 0, 3
+	MUL $gp, 4
+	CFLO $sp, 0
+	MUL $gp, 5
+	CFLO $sp, 0
+	BNE $gp, 1, 2          # to bad
+	EXIT 0
+bad:	EXIT 1
+middle:	SRI $sp, 1
+	SWR $sp, 0, $ra
+	CALL leaf
+	CALL leaf
+	LWR $ra, $sp, 0
+	ARI $sp, 1
+	RTN
+leaf:	ADDI $gp, 1, 1
+	RTN
+	.data 1024
+	WORD left = 0
+	WORD made = 0
+	WORD address = 0
+	WORD rounds = 20
+	WORD calls = 60000
+	WORD factor = 20
+	.stack 4096
+	.end
@@ -0,0 +1,32 @@
+# Naive recursive Fibonacci: fib(23) 20 times, about 1.8 million calls
+# fib takes n on top of the stack and replaces it with fib(n).
+# Its frame: sp+0 argument to the next call, sp+1 saved $ra,
+# sp+2 fib(n-2), sp+3 n (and then the result)
+	.text start
+start:	SRI $sp, 1
+again:	LIT $sp, 0, 23
+	CALL fib
+	BNE $gp, 0, 4       # fib(23) should be 28657
+	ADDI $gp, 1, -1
+	BGTZ $gp, 1, -4     # to again
+	EXIT 0
+	EXIT 1
+fib:	SRI $sp, 3
+	SWR $sp, 1, $ra
+	CPW $sp, 0, $sp, 3  # argument = n - 2
+	ADDI $sp, 0, -2
+	BLTZ $sp, 0, 7      # n < 2: fib(n) = n, already in place
+	CALL fib            # fib(n-2)
+	CPW $sp, 2, $sp, 0
+	CPW $sp, 0, $sp, 3  # argument = n - 1
+	ADDI $sp, 0, -1
+	CALL fib            # fib(n-1)
+	ADD $sp, 3, $sp, 2  # result = fib(n-1) + fib(n-2)
+	LWR $ra, $sp, 1
+	ARI $sp, 3
+	RTN
+	.data 1024
+	WORD expected = 28657
+	WORD runs = 20
+	.stack 4096
+	.end
@@ -0,0 +1,34 @@
+# Nested counting loops: 300 x 300 x 100 iterations of a 3-instruction body
+# Data words: 0 = i, 1 = j, 2 = k, 3 and 4 = factors of the expected sum
+	.text start
+start:	SRI $sp, 1          # the sum is kept on top of the stack
+	LIT $sp, 0, 0
+	ADDI $gp, 0, 300    # i = 300
+outer:	LIT $gp, 1, 0       # j = 300
+	ADDI $gp, 1, 300
+middle:	LIT $gp, 2, 0       # k = 100
+	ADDI $gp, 2, 100
+inner:	ADD $sp, 0, $gp, 2  # sum += k
+	ADDI $gp, 2, -1
+	BGTZ $gp, 2, -2     # to inner
+	ADDI $gp, 1, -1
+	BGTZ $gp, 1, -6     # to middle
+	ADDI $gp, 0, -1
+	BGTZ $gp, 0, -10    # to outer
+	SRI $sp, 1          # the sum should be 300 * 300 * 5050
+	LIT $sp, 0, 300
+	MUL $gp, 3
+	CFLO $sp, 0
+	MUL $gp, 4
+	CFLO $sp, 0
+	BNE $sp, 1, 2
+	EXIT 0
+	EXIT 1
+	.data 1024
+	WORD i = 0
+	WORD j = 0
+	WORD k = 0
+	WORD rows = 300
+	WORD triangle = 5050
+	.stack 4096
+	.end
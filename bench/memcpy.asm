@@ -0,0 +1,37 @@
+# Block copy: 2000 words from address 10000 to address 20000, 1500 times
+# Data words: 0 = source, 1 = destination, 2 = words left, 3 = copies left,
+# 4 = words per copy
+	.text start
+start:	LWR $r3, $gp, 0       # fill the source with 2000, 1999, ..., 1
+	CPW $gp, 2, $gp, 4
+fill:	CPW $r3, 0, $gp, 2
+	ARI $r3, 1
+	ADDI $gp, 2, -1
+	BGTZ $gp, 2, -3       # to fill
+copy:	LWR $r3, $gp, 0
+	LWR $r4, $gp, 1
+	CPW $gp, 2, $gp, 4
+word:	CPW $r4, 0, $r3, 0
+	ARI $r3, 1
+	ARI $r4, 1
+	ADDI $gp, 2, -1
+	BGTZ $gp, 2, -4       # to word
+	ADDI $gp, 3, -1
+	BGTZ $gp, 3, -9       # to copy
+	LWR $r4, $gp, 1       # the destination should start with 2000 and end with 1
+	SRI $sp, 1
+	CPW $sp, 0, $gp, 4
+	BNE $r4, 0, 5         # to bad
+	ARI $r4, 1999
+	LIT $sp, 0, 1
+	BNE $r4, 0, 2         # to bad
+	EXIT 0
+bad:	EXIT 1
+	.data 1024
+	WORD source = 10000
+	WORD destination = 20000
+	WORD left = 0
+	WORD copies = 1500
+	WORD size = 2000
+	.stack 4096
+	.end
@@ -0,0 +1,67 @@
+# Insertion sort of 1000 pseudo-random words at address 10000, 10 times
+# (refilled from a 16-bit linear congruential generator each time), then
+# a check that the last sort left them in order
+# Data words: 0 = array, 1 = length, 2 = seed, 3 = sorts left, 4 = i,
+# 5 = j, 6 = scratch, 7 = multiplier, 8 = words left to fill, 9 = i's left,
+# 10 = increment
+	.text start
+start:	SRI $sp, 1             # top of stack: seed, then the key being inserted
+rep:	LWR $r3, $gp, 0
+	CPW $gp, 8, $gp, 1
+fill:	CPW $sp, 0, $gp, 2     # seed = seed * 25173 + 13849
+	MUL $gp, 7
+	CFLO $sp, 0
+	ADD $gp, 2, $gp, 10
+	CPW $r3, 0, $gp, 2
+	ANDI $r3, 0, 0xffff    # keep the low 16 bits
+	ARI $r3, 1
+	ADDI $gp, 8, -1
+	BGTZ $gp, 8, -8        # to fill
+	LWR $r4, $gp, 0        # $r4 = &a[i], for i = 1 to length - 1
+	ARI $r4, 1
+	CPW $gp, 9, $gp, 1
+	ADDI $gp, 9, -1
+	LIT $gp, 4, 1
+outer:	CPW $sp, 0, $r4, 0     # key = a[i]
+	CPW $gp, 5, $gp, 4     # j = i, $r3 = &a[j]
+	SWR $gp, 6, $r4
+	LWR $r3, $gp, 6
+inner:	SUB $gp, 6, $r3, -1    # while key < a[j-1]
+	BGEZ $gp, 6, 5         # to place
+	CPW $r3, 0, $r3, -1    # a[j] = a[j-1]
+	SRI $r3, 1
+	ADDI $gp, 5, -1
+	BGTZ $gp, 5, -5        # to inner, while j > 0
+place:	CPW $r3, 0, $sp, 0     # a[j] = key
+	ARI $r4, 1
+	ADDI $gp, 4, 1
+	ADDI $gp, 9, -1
+	BGTZ $gp, 9, -14       # to outer
+	ADDI $gp, 3, -1
+	BGTZ $gp, 3, -32       # to rep
+	LWR $r3, $gp, 0        # check a[k-1] <= a[k], for k = 1 to length - 1
+	ARI $r3, 1
+	CPW $gp, 9, $gp, 1
+	ADDI $gp, 9, -1
+check:	CPW $sp, 0, $r3, 0
+	SUB $gp, 6, $r3, -1
+	BLTZ $gp, 6, 5         # to bad
+	ARI $r3, 1
+	ADDI $gp, 9, -1
+	BGTZ $gp, 9, -5        # to check
+	EXIT 0
+bad:	EXIT 1
+	.data 1024
+	WORD array = 10000
+	WORD length = 1000
+	WORD seed = 1
+	WORD sorts = 10
+	WORD index = 0
+	WORD inner_index = 0
+	WORD scratch = 0
+	WORD multiplier = 25173
+	WORD unfilled = 0
+	WORD remaining = 0
+	WORD increment = 13849
+	.stack 4096
+	.end
@@ -0,0 +1,45 @@
+# Guest output: 200000 lines, each a 30-character string printed with PSTR
+# and then 16 characters printed one at a time with PCH
+# Data words: 0 = lines left, 1 = characters left, 2 = character pointer,
+# 3-10 = the string, 11-26 = the characters, 27 = rounds left,
+# 28 = lines per round
+	.text start
+start:	SCA $gp, 2, $gp, 11    # the characters' address
+round:	CPW $gp, 0, $gp, 28
+line:	PSTR $gp, 3
+	LWR $r3, $gp, 2
+	LIT $gp, 1, 16
+char:	PCH $r3, 0
+	ARI $r3, 1
+	ADDI $gp, 1, -1
+	BGTZ $gp, 1, -3        # to char
+	ADDI $gp, 0, -1
+	BGTZ $gp, 0, -8        # to line
+	ADDI $gp, 27, -1
+	BGTZ $gp, 27, -11      # to round
+	EXIT 0
+	.data 1024
+	WORD lines = 0
+	WORD left = 0
+	WORD pointer = 0
+	STRING[8] text = "Benchmark line printed by PSTR"
+	CHAR c0 = '0'
+	CHAR c1 = '1'
+	CHAR c2 = '2'
+	CHAR c3 = '3'
+	CHAR c4 = '4'
+	CHAR c5 = '5'
+	CHAR c6 = '6'
+	CHAR c7 = '7'
+	CHAR c8 = '8'
+	CHAR c9 = '9'
+	CHAR ca = 'a'
+	CHAR cb = 'b'
+	CHAR cc = 'c'
+	CHAR cd = 'd'
+	CHAR ce = 'e'
+	CHAR nl = '\n'
+	WORD rounds = 5
+	WORD per_round = 40000
+	.stack 4096
+	.end
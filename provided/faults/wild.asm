@@ -0,0 +1,7 @@
+# Jumps past the end of an 8192-word guest memory (run with --memory 8192)
+	.text start
+start:	JMPA 20000
+	EXIT 0
+	.data 1024
+	.stack 4096
+	.end
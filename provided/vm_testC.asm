@@ -0,0 +1,33 @@
+	.text start
+start:	SRI $sp, 1
+	LIT $sp, 0, 1
+	SLL $sp, 0, 31    # stack top is INT_MIN
+	DIV $gp, 0        # INT_MIN / -1 wraps: LO is INT_MIN, HI is 0
+	CFLO $gp, 1       # lo is INT_MIN
+	CFHI $gp, 2       # hi is 0
+	BNE $gp, 1, 17    # exit 1 unless lo is INT_MIN
+	LIT $sp, 0, 0
+	BNE $gp, 2, 15    # exit 1 unless hi is 0
+	LIT $sp, 0, 3
+	SLL $sp, 0, 33    # shift counts are mod 32: stack top is 6
+	BNE $gp, 3, 12    # exit 1 unless it is
+	LIT $sp, 0, -1
+	SRL $sp, 0, 63    # stack top is 1
+	BNE $gp, 4, 9     # exit 1 unless it is
+	LIT $sp, 0, 1
+	SLL $sp, 0, 31
+	ADD $sp, 0, $gp, 0  # INT_MIN + -1 wraps to INT_MAX
+	ADDI $sp, 0, 1    # INT_MAX + 1 wraps to INT_MIN
+	BNE $gp, 1, 4     # exit 1 unless it is lo
+	NEG $sp, 0, $gp, 1  # -INT_MIN wraps to INT_MIN
+	BNE $gp, 1, 2     # exit 1 unless it is lo
+	EXIT 0
+	EXIT 1
+	.data 1024
+	WORD m = -1
+	WORD lo = 1
+	WORD hi = 1
+	WORD six = 6
+	WORD one = 1
+	.stack 4096
+	.end
@@ -0,0 +1,378 @@
+#define _GNU_SOURCE
+#include "batch.h"
+#include "sandbox.h"
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+// Batch runner (vm --batch): runs many programs on a pool of worker
+// threads. Each worker owns a deque of jobs; it takes work from the
+// bottom of its own deque and, when that is empty, steals from the top of
+// another's. A job runs for one quantum at a time and then goes back on
+// top of its worker's deque, so long programs can't hold up short ones.
+// Sandboxed jobs are the exception: each reserves tens of GiB of address
+// space, so a worker keeps running its job until it finishes rather than
+// starting the next, which keeps at most one sandboxed VM per worker alive.
+// Each job's output is collected in memory and written out in the order
+// the programs were given.
+
+typedef struct {
+    const char *file;
+    VM vm;
+    bool started;
+    FILE *out;                  // memory stream collecting the job's output
+    char *output;
+    size_t output_len;
+    char error[256];            // why the job could not run, if it could not
+    vm_status_t status;         // final status, with steps over all slices
+    bool done;
+} batch_job;
+
+// A worker's deque of job indices, a ring buffer with room for every job
+typedef struct {
+    pthread_mutex_t lock;
+    int *jobs;
+    int top;                    // index of the top (stealing) end
+    int count;
+} job_deque;
+
+typedef struct batch {
+    const batch_options *options;
+    batch_job *jobs;
+    int num_jobs;
+    job_deque *deques;
+    int num_workers;
+    int capacity;               // size of each deque's ring
+
+    atomic_int queued;          // jobs sitting in deques
+    atomic_int remaining;       // jobs not yet done
+    pthread_mutex_t lock;       // guards sleeping on the two conditions
+    pthread_cond_t work_ready;  // a job was queued, or all are done
+    pthread_cond_t job_done;    // some job finished
+} batch;
+
+typedef struct {
+    batch *b;
+    int id;
+} worker_arg;
+
+static void push_bottom(batch *b, job_deque *d, int job) {
+    pthread_mutex_lock(&d->lock);
+    d->jobs[(d->top + d->count) % b->capacity] = job;
+    d->count++;
+    pthread_mutex_unlock(&d->lock);
+}
+
+static void push_top(batch *b, job_deque *d, int job) {
+    pthread_mutex_lock(&d->lock);
+    d->top = (d->top + b->capacity - 1) % b->capacity;
+    d->jobs[d->top] = job;
+    d->count++;
+    pthread_mutex_unlock(&d->lock);
+}
+
+// Take the job at the bottom (the owner's end), or -1 if there is none
+static int pop_bottom(batch *b, job_deque *d) {
+    int job = -1;
+    pthread_mutex_lock(&d->lock);
+    if (d->count > 0) {
+        d->count--;
+        job = d->jobs[(d->top + d->count) % b->capacity];
+    }
+    pthread_mutex_unlock(&d->lock);
+    return job;
+}
+
+// Take the job at the top (the thieves' end), or -1 if there is none
+static int steal_top(batch *b, job_deque *d) {
+    int job = -1;
+    pthread_mutex_lock(&d->lock);
+    if (d->count > 0) {
+        job = d->jobs[d->top];
+        d->top = (d->top + 1) % b->capacity;
+        d->count--;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return job;
+}
+
+// Put a job back in line and wake a sleeping worker. The job goes on top,
+// behind the others, unless the batch is sandboxed; then it goes back on
+// the bottom, so the worker takes it again next.
+static void requeue(batch *b, int worker, int job) {
+    if (b->options->sandbox) {
+        push_bottom(b, &b->deques[worker], job);
+    } else {
+        push_top(b, &b->deques[worker], job);
+    }
+    atomic_fetch_add(&b->queued, 1);
+    pthread_mutex_lock(&b->lock);
+    pthread_cond_signal(&b->work_ready);
+    pthread_mutex_unlock(&b->lock);
+}
+
+// Find the next job for worker: its own first, then anyone else's.
+// Returns -1 once every job is done.
+static int next_job(batch *b, int worker) {
+    for (;;) {
+        int job = pop_bottom(b, &b->deques[worker]);
+        for (int i = 1; job < 0 && i < b->num_workers; i++) {
+            job = steal_top(b, &b->deques[(worker + i) % b->num_workers]);
+        }
+        if (job >= 0) {
+            atomic_fetch_sub(&b->queued, 1);
+            return job;
+        }
+        pthread_mutex_lock(&b->lock);
+        while (atomic_load(&b->queued) == 0 && atomic_load(&b->remaining) > 0) {
+            pthread_cond_wait(&b->work_ready, &b->lock);
+        }
+        bool finished = atomic_load(&b->remaining) == 0;
+        pthread_mutex_unlock(&b->lock);
+        if (finished) {
+            return -1;
+        }
+    }
+}
+
+// Load the job's program and print its initial state, as vm does.
+// Returns false (with job->error set) if the program can't be loaded.
+static bool job_start(batch *b, batch_job *job) {
+    job->started = true;
+    job->out = open_memstream(&job->output, &job->output_len);
+    if (!job->out) {
+        perror("Error opening job output stream");
+        exit(EXIT_FAILURE);
+    }
+    if (b->options->sandbox) {
+        vm_init_sandbox(&job->vm);
+    } else {
+        vm_init(&job->vm);
+    }
+    if (b->options->memory_words != VM_MAX_WORDS) {
+        vm_set_memory_words(&job->vm, b->options->memory_words);
+    }
+    vm_set_output(&job->vm, job->out);
+    if (!vm_read_program(&job->vm, job->file, job->error, sizeof(job->error))) {
+        vm_free(&job->vm);
+        return false;
+    }
+    if (b->options->quiet) {
+        job->vm.tracing = false;
+    } else {
+        print_registers(&job->vm);
+        print_words(&job->vm);
+    }
+    job->vm.engine = b->options->engine;
+    job->vm.jit_threshold = b->options->jit_threshold;
+    job->status.steps = 0;
+    return true;
+}
+
+// Finish the job's output and release its VM
+static void job_finish(batch *b, batch_job *job, bool loaded) {
+    if (loaded) {
+        if (b->options->quiet) {
+            print_registers(&job->vm);
+            print_words(&job->vm);
+            trace_flush(job->vm.trace);
+            fprintf(job->out, "%llu instructions\n", (unsigned long long) job->status.steps);
+        }
+        vm_free(&job->vm);
+    }
+    fclose(job->out);
+
+    pthread_mutex_lock(&b->lock);
+    job->done = true;
+    atomic_fetch_sub(&b->remaining, 1);
+    pthread_cond_broadcast(&b->job_done);
+    if (atomic_load(&b->remaining) == 0) {
+        pthread_cond_broadcast(&b->work_ready);
+    }
+    pthread_mutex_unlock(&b->lock);
+}
+
+// Pin the calling thread to the id-th CPU it is allowed to run on
+static void pin_to_cpu(int id) {
+#ifdef __linux__
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0) {
+        return;
+    }
+    int n = id % CPU_COUNT(&allowed);
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &allowed) && n-- == 0) {
+            cpu_set_t one;
+            CPU_ZERO(&one);
+            CPU_SET(cpu, &one);
+            pthread_setaffinity_np(pthread_self(), sizeof(one), &one);
+            return;
+        }
+    }
+#endif
+}
+
+static void *worker_main(void *arg) {
+    batch *b = ((worker_arg *) arg)->b;
+    int id = ((worker_arg *) arg)->id;
+    pin_to_cpu(id);
+
+    int job_index;
+    while ((job_index = next_job(b, id)) >= 0) {
+        batch_job *job = &b->jobs[job_index];
+        if (!job->started && !job_start(b, job)) {
+            job_finish(b, job, false);
+            continue;
+        }
+        vm_status_t slice = vm_execute(&job->vm, b->options->quantum);
+        uint64_t steps = job->status.steps + slice.steps;
+        job->status = slice;
+        job->status.steps = steps;
+        if (slice.state == VM_RUNNING) {
+            requeue(b, id, job_index);
+        } else {
+            job_finish(b, job, true);
+        }
+    }
+    return NULL;
+}
+
+// Run every program in files, writing their outputs in order to stdout and
+// their fault messages to stderr. Returns EXIT_SUCCESS if every program
+// ran to EXIT, EXIT_FAILURE otherwise.
+int batch_run(const batch_options *options, char **files, int num_files) {
+    batch b;
+    b.options = options;
+    b.num_jobs = num_files;
+    b.num_workers = options->workers > 0 ? options->workers : (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (b.num_workers < 1) {
+        b.num_workers = 1;
+    }
+    if (b.num_workers > num_files && num_files > 0) {
+        b.num_workers = num_files;
+    }
+    b.capacity = num_files > 0 ? num_files : 1;
+    b.jobs = calloc(b.capacity, sizeof(batch_job));
+    b.deques = calloc(b.num_workers, sizeof(job_deque));
+    pthread_t *threads = calloc(b.num_workers, sizeof(pthread_t));
+    worker_arg *args = calloc(b.num_workers, sizeof(worker_arg));
+    if (!b.jobs || !b.deques || !threads || !args) {
+        perror("Error allocating batch");
+        exit(EXIT_FAILURE);
+    }
+    atomic_init(&b.queued, num_files);
+    atomic_init(&b.remaining, num_files);
+    pthread_mutex_init(&b.lock, NULL);
+    pthread_cond_init(&b.work_ready, NULL);
+    pthread_cond_init(&b.job_done, NULL);
+
+    //Deal the jobs out round-robin, each worker starting on its first one.
+    for (int w = 0; w < b.num_workers; w++) {
+        pthread_mutex_init(&b.deques[w].lock, NULL);
+        b.deques[w].jobs = malloc(b.capacity * sizeof(int));
+        if (!b.deques[w].jobs) {
+            perror("Error allocating batch");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int i = num_files - 1; i >= 0; i--) {
+        b.jobs[i].file = files[i];
+        push_bottom(&b, &b.deques[i % b.num_workers], i);
+    }
+
+    for (int w = 0; w < b.num_workers; w++) {
+        args[w].b = &b;
+        args[w].id = w;
+        if (pthread_create(&threads[w], NULL, worker_main, &args[w]) != 0) {
+            perror("Error starting batch worker");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    //Write each job's output as soon as it and every job before it are done.
+    int result = EXIT_SUCCESS;
+    for (int i = 0; i < num_files; i++) {
+        batch_job *job = &b.jobs[i];
+        pthread_mutex_lock(&b.lock);
+        while (!job->done) {
+            pthread_cond_wait(&b.job_done, &b.lock);
+        }
+        pthread_mutex_unlock(&b.lock);
+
+        fwrite(job->output, 1, job->output_len, stdout);
+        fflush(stdout);
+        if (job->error[0]) {
+            fprintf(stderr, "%s\n", job->error);
+            result = EXIT_FAILURE;
+        } else if (job->status.state == VM_FAULTED) {
+            fprintf(stderr, "%s: %s at address %d (after %llu instructions)\n", job->file,
+                    job->status.fault_msg, job->status.fault_pc,
+                    (unsigned long long) job->status.steps);
+            result = EXIT_FAILURE;
+        }
+        free(job->output);
+    }
+
+    for (int w = 0; w < b.num_workers; w++) {
+        pthread_join(threads[w], NULL);
+    }
+    for (int w = 0; w < b.num_workers; w++) {
+        pthread_mutex_destroy(&b.deques[w].lock);
+        free(b.deques[w].jobs);
+    }
+    pthread_cond_destroy(&b.job_done);
+    pthread_cond_destroy(&b.work_ready);
+    pthread_mutex_destroy(&b.lock);
+    free(args);
+    free(threads);
+    free(b.deques);
+    free(b.jobs);
+    return result;
+}
+
+// Read a manifest: one BOF file name per line (blank lines and lines
+// starting with # are skipped). Sets *num_files and returns the names.
+char **batch_read_manifest(const char *filename, int *num_files) {
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        perror("Error opening manifest");
+        exit(EXIT_FAILURE);
+    }
+    char **files = NULL;
+    int count = 0, capacity = 0;
+    char *line = NULL;
+    size_t line_size = 0;
+    ssize_t len;
+    while ((len = getline(&line, &line_size, file)) >= 0) {
+        while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'
+                           || line[len - 1] == ' ' || line[len - 1] == '\t')) {
+            line[--len] = '\0';
+        }
+        if (len == 0 || line[0] == '#') {
+            continue;
+        }
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            files = realloc(files, capacity * sizeof(char *));
+            if (!files) {
+                perror("Error allocating manifest");
+                exit(EXIT_FAILURE);
+            }
+        }
+        files[count] = strdup(line);
+        if (!files[count]) {
+            perror("Error allocating manifest");
+            exit(EXIT_FAILURE);
+        }
+        count++;
+    }
+    free(line);
+    fclose(file);
+    *num_files = count;
+    return files;
+}
@@ -0,0 +1,26 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "vm.h"
+
+// Default instructions a guest runs before it goes to the back of the line
+#define BATCH_QUANTUM 100000
+
+// How vm --batch runs its jobs
+typedef struct {
+    engine_type engine;         // engine for untraced stretches
+    uint32_t jit_threshold;     // for JIT_ENGINE
+    bool quiet;                 // like vm -q
+    int workers;                // worker threads; 0 for one per online CPU
+    uint64_t quantum;           // instructions per time slice
+    uint32_t memory_words;      // guest memory per program (see vm_set_memory_words)
+    bool sandbox;               // give each program guard regions (see sandbox.c)
+} batch_options;
+
+// Function declarations
+int batch_run(const batch_options *options, char **files, int num_files);
+char **batch_read_manifest(const char *filename, int *num_files);
+
+#endif // BATCH_H
@@ -0,0 +1,340 @@
+// bof2c: translate a BOF program ahead of time into one C source file.
+// Each text address becomes a label and each instruction a few lines of
+// C over a guest memory array; jumps through memory or $ra (JMP, CSI,
+// RTN) go through a switch from address to label. The output includes
+// bof2c_rt.h, and builds into a native program with
+//     cc -O2 -Isrc prog.c src/bof2c_rt.c -o prog
+// It prints only the program's own output (tracing is not translated).
+// The translation is fixed, so a store into the text section, or a jump
+// outside it, stops the program with a fault where the VM would go on.
+#include "vm.h"
+#include "bof2c_rt.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Data words written per line of the output
+#define BOF2C_WORDS_PER_LINE 8
+
+static FILE *out;
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-o FILE] <program.bof>\n", prog);
+    fprintf(stderr, "  -o FILE  write the C source to FILE instead of stdout\n");
+    exit(EXIT_FAILURE);
+}
+
+// Print register reg plus offset, an effective address
+static void print_addr(int reg, int32_t offset) {
+    if (offset == 0) {
+        fprintf(out, "r[%d]", reg);
+    } else {
+        fprintf(out, "r[%d] %c %d", reg, offset < 0 ? '-' : '+', offset < 0 ? -offset : offset);
+    }
+}
+
+// Print "t = <target address>;" and the check that the store it is for
+// leaves the text alone
+static void print_store_target(int32_t addr, const decoded_instr_t *d) {
+    fprintf(out, "    t = ");
+    print_addr(d->rt, d->ot);
+    fprintf(out, ";\n    CHECK_STORE(%d, t);\n", addr);
+}
+
+// Print a transfer to target: a goto if it is in the text, else a fault
+// through the dispatch switch
+static void print_goto(int32_t target, int32_t text_length) {
+    if (target >= 0 && target < text_length) {
+        fprintf(out, "goto L%d;\n", target);
+    } else {
+        fprintf(out, "{ pc = %d; goto dispatch; }\n", target);
+    }
+}
+
+// Print a conditional branch on the word d names: transfer to the target
+// if the stack top compares to it by cond or, when cond is a comparison
+// with 0, if it does
+static void print_branch(const decoded_instr_t *d, const char *cond, int32_t text_length) {
+    bool with_top = strchr(cond, '0') == NULL;
+    fprintf(out, "    if (");
+    if (with_top) {
+        fprintf(out, "m[r[SP]] %s ", cond);
+    }
+    fprintf(out, "m[");
+    print_addr(d->rt, d->ot);
+    fprintf(out, "]");
+    if (!with_top) {
+        fprintf(out, " %s", cond);
+    }
+    fprintf(out, ") ");
+    print_goto(d->target, text_length);
+}
+
+// Print the C for the instruction d at addr
+static void print_instruction_c(int32_t addr, const decoded_instr_t *d, int32_t text_length) {
+    static const char *binary_ops[NUM_BASE_HANDLERS] = {
+        [AND_H] = "&", [BOR_H] = "|", [XOR_H] = "^",
+    };
+    static const char *immediate_ops[NUM_BASE_HANDLERS] = {
+        [ANDI_H] = "&=", [BORI_H] = "|=", [XORI_H] = "^=",
+    };
+    static const char *branch_conds[NUM_BASE_HANDLERS] = {
+        [BEQ_H] = "==", [BNE_H] = "!=",
+        [BGEZ_H] = ">= 0", [BGTZ_H] = "> 0", [BLEZ_H] = "<= 0", [BLTZ_H] = "< 0",
+    };
+
+    switch (d->handler) {
+        case NOP_H:
+        case STRA_H:
+        case NOTR_H:
+            fprintf(out, "    ;\n");
+            break;
+        case ADD_H:
+        case SUB_H:
+            print_store_target(addr, d);
+            fprintf(out, "    m[t] = bof2c_%s(m[r[SP]], m[", d->handler == ADD_H ? "add" : "sub");
+            print_addr(d->rs, d->os);
+            fprintf(out, "]);\n");
+            break;
+        case CPW_H:
+        case NEG_H:
+            print_store_target(addr, d);
+            fprintf(out, "    m[t] = %sm[", d->handler == NEG_H ? "bof2c_neg(" : "");
+            print_addr(d->rs, d->os);
+            fprintf(out, "]%s;\n", d->handler == NEG_H ? ")" : "");
+            break;
+        case AND_H:
+        case BOR_H:
+        case XOR_H:
+            print_store_target(addr, d);
+            fprintf(out, "    m[t] = m[r[SP]] %s m[", binary_ops[d->handler]);
+            print_addr(d->rs, d->os);
+            fprintf(out, "];\n");
+            break;
+        case NOR_H:
+            print_store_target(addr, d);
+            fprintf(out, "    m[t] = ~(m[r[SP]] | m[");
+            print_addr(d->rs, d->os);
+            fprintf(out, "]);\n");
+            break;
+        case LWR_H:
+            fprintf(out, "    r[%d] = m[", d->rt);
+            print_addr(d->rs, d->os);
+            fprintf(out, "];\n");
+            break;
+        case SWR_H:
+            print_store_target(addr, d);
+            fprintf(out, "    m[t] = r[%d];\n", d->rs);
+            break;
+        case SCA_H:
+            print_store_target(addr, d);
+            fprintf(out, "    m[t] = ");
+            print_addr(d->rs, d->os);
+            fprintf(out, ";\n");
+            break;
+        case LWI_H:
+            print_store_target(addr, d);
+            fprintf(out, "    m[t] = m[m[");
+            print_addr(d->rs, d->os);
+            fprintf(out, "]];\n");
+            break;
+        case LIT_H:
+            print_store_target(addr, d);
+            fprintf(out, "    m[t] = %d;\n", d->imm);
+            break;
+        case ARI_H:
+        case SRI_H:
+            fprintf(out, "    r[%d] = bof2c_%s(r[%d], %d);\n", d->rt, d->handler == ARI_H ? "add" : "sub",
+                    d->rt, d->imm);
+            break;
+        case MUL_H:
+            fprintf(out, "    p = (int64_t) m[r[SP]] * m[");
+            print_addr(d->rt, d->ot);
+            fprintf(out, "];\n    hi = (int32_t) (p >> 32);\n    lo = (int32_t) p;\n");
+            break;
+        case DIV_H:
+            fprintf(out, "    s = m[");
+            print_addr(d->rt, d->ot);
+            fprintf(out, "];\n    if (s == 0) bof2c_fault(%d, \"division by zero\");\n"
+                    "    if (s == -1 && m[r[SP]] == INT32_MIN) {\n"
+                    "        hi = 0;\n        lo = INT32_MIN;\n"
+                    "    } else {\n"
+                    "        hi = m[r[SP]] %% s;\n        lo = m[r[SP]] / s;\n    }\n", addr);
+            break;
+        case CFHI_H:
+        case CFLO_H:
+            print_store_target(addr, d);
+            fprintf(out, "    m[t] = %s;\n", d->handler == CFHI_H ? "hi" : "lo");
+            break;
+        case SLL_H:
+        case SRL_H:
+            print_store_target(addr, d);
+            fprintf(out, "    m[t] = (int32_t) ((uint32_t) m[r[SP]] %s %d);\n",
+                    d->handler == SLL_H ? "<<" : ">>", d->imm);
+            break;
+        case JMP_H:
+            fprintf(out, "    pc = m[");
+            print_addr(d->rt, d->ot);
+            fprintf(out, "];\n    goto dispatch;\n");
+            break;
+        case CSI_H:
+            fprintf(out, "    t = ");
+            print_addr(d->rt, d->ot);
+            fprintf(out, ";\n    r[RA] = %d;\n    pc = m[t];\n    goto dispatch;\n", addr + 1);
+            break;
+        case JREL_H:
+        case JMPA_H:
+            fprintf(out, "    ");
+            print_goto(d->target, text_length);
+            break;
+        case CALL_H:
+            fprintf(out, "    r[RA] = %d;\n    ", addr + 1);
+            print_goto(d->target, text_length);
+            break;
+        case RTN_H:
+            fprintf(out, "    pc = r[RA];\n    goto dispatch;\n");
+            break;
+        case ADDI_H:
+            print_store_target(addr, d);
+            fprintf(out, "    m[t] = bof2c_add(m[t], %d);\n", d->imm);
+            break;
+        case ANDI_H:
+        case BORI_H:
+        case XORI_H:
+            print_store_target(addr, d);
+            fprintf(out, "    m[t] %s %d;\n", immediate_ops[d->handler], d->imm);
+            break;
+        case NORI_H:
+            print_store_target(addr, d);
+            fprintf(out, "    m[t] = ~(m[t] | %d);\n", d->imm);
+            break;
+        case BEQ_H:
+        case BNE_H:
+        case BGEZ_H:
+        case BGTZ_H:
+        case BLEZ_H:
+        case BLTZ_H:
+            print_branch(d, branch_conds[d->handler], text_length);
+            break;
+        case EXIT_H:
+            fprintf(out, "    bof2c_exit(%d);\n", d->imm);
+            break;
+        case PSTR_H:
+        case PINT_H:
+        case PCH_H:
+            fprintf(out, "    s = ");
+            if (d->handler == PSTR_H) {
+                fprintf(out, "bof2c_pstr(m, ");
+                print_addr(d->rt, d->ot);
+            } else {
+                fprintf(out, "bof2c_%s(m[", d->handler == PINT_H ? "pint" : "pch");
+                print_addr(d->rt, d->ot);
+                fprintf(out, "]");
+            }
+            fprintf(out, ");\n    t = r[SP];\n    CHECK_STORE(%d, t);\n    m[t] = s;\n", addr);
+            break;
+        case RCH_H:
+            print_store_target(addr, d);
+            fprintf(out, "    m[t] = bof2c_rch();\n");
+            break;
+        default:
+            fprintf(out, "    bof2c_fault(%d, \"illegal instruction\");\n", addr);
+            break;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const char *output = NULL;
+    int argi = 1;
+    if (argi + 1 < argc && strcmp(argv[argi], "-o") == 0) {
+        output = argv[argi + 1];
+        argi += 2;
+    }
+    if (argi + 1 != argc) {
+        usage(argv[0]);
+    }
+    const char *filename = argv[argi];
+
+    BOFFILE bf = bof_read_open(filename);
+    BOFHeader header = bof_read_header(bf);
+    //The translated program's memory is fixed, so check the fit now
+    char error[512];
+    if (!vm_check_program(&header, bof_file_bytes(bf), BOF2C_MEMORY_WORDS, filename, error, sizeof(error))) {
+        fprintf(stderr, "%s\n", error);
+        exit(EXIT_FAILURE);
+    }
+    int32_t text_length = header.text_length;
+    bin_instr_t *text = malloc((text_length > 0 ? text_length : 1) * sizeof(bin_instr_t));
+    word_type *data = malloc((header.data_length > 0 ? header.data_length : 1) * sizeof(word_type));
+    if (!text || !data) {
+        perror("Error allocating program");
+        exit(EXIT_FAILURE);
+    }
+    for (int32_t i = 0; i < text_length; i++) {
+        text[i] = instruction_read(bf);
+    }
+    for (int32_t i = 0; i < header.data_length; i++) {
+        data[i] = bof_read_word(bf);
+    }
+    bof_close(bf);
+
+    out = stdout;
+    if (output && !(out = fopen(output, "w"))) {
+        perror(output);
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(out, "// Translated from %s by bof2c\n", filename);
+    fprintf(out, "#include \"bof2c_rt.h\"\n\n");
+    fprintf(out, "#define TEXT_LENGTH %d\n", text_length);
+    fprintf(out, "#define SP %d\n#define RA %d\n\n", SP, RA);
+    fprintf(out, "// Stop at a store that would change the program; its translation is fixed\n");
+    fprintf(out, "#define CHECK_STORE(pc, a) \\\n"
+            "    if ((uint32_t) (a) < TEXT_LENGTH) bof2c_fault(pc, \"store into the text section\")\n\n");
+
+    fprintf(out, "static const uint32_t text[%d] = {", text_length > 0 ? text_length : 1);
+    for (int32_t i = 0; i < text_length; i++) {
+        uint32_t bits;
+        memcpy(&bits, &text[i], sizeof(bits));
+        fprintf(out, "%s0x%08x,", i % BOF2C_WORDS_PER_LINE ? " " : "\n    ", bits);
+    }
+    fprintf(out, "%s};\n\n", text_length > 0 ? "\n" : "0");
+    fprintf(out, "static const int32_t data[%d] = {", header.data_length > 0 ? header.data_length : 1);
+    for (int32_t i = 0; i < header.data_length; i++) {
+        fprintf(out, "%s%d,", i % BOF2C_WORDS_PER_LINE ? " " : "\n    ", data[i]);
+    }
+    fprintf(out, "%s};\n\n", header.data_length > 0 ? "\n" : "0");
+
+    fprintf(out, "int main(void) {\n");
+    fprintf(out, "    int32_t r[%d] = {%d, %d, %d};\n", NUM_REGISTERS, header.data_start_address,
+            header.stack_bottom_addr, header.stack_bottom_addr);
+    fprintf(out, "    int32_t hi = 0, lo = 0, pc = %d, t, s;\n", header.text_start_address);
+    fprintf(out, "    int64_t p;\n");
+    fprintf(out, "    int32_t *m = bof2c_start(text, TEXT_LENGTH, data, %d, %d);\n",
+            header.data_start_address, header.data_length);
+    fprintf(out, "    (void) hi, (void) lo, (void) t, (void) s, (void) p;\n");
+    fprintf(out, "    goto dispatch;\n\n");
+    for (int32_t i = 0; i < text_length; i++) {
+        decoded_instr_t d;
+        vm_decode(text[i], i, &d);
+        fprintf(out, "L%d: // %s\n", i, instruction_assembly_form(i, text[i]));
+        print_instruction_c(i, &d, text_length);
+    }
+    //Running off the end of the text faults in the switch
+    fprintf(out, "    pc = TEXT_LENGTH;\n\n");
+
+    fprintf(out, "dispatch:\n    switch (pc) {\n");
+    for (int32_t i = 0; i < text_length; i++) {
+        fprintf(out, "        case %d: goto L%d;\n", i, i);
+    }
+    fprintf(out, "        default: bof2c_fault(pc, \"jump outside the text section\");\n");
+    fprintf(out, "    }\n}\n");
+
+    if (out != stdout && fclose(out) != 0) {
+        perror(output);
+        exit(EXIT_FAILURE);
+    }
+    free(text);
+    free(data);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,62 @@
+#include "bof2c_rt.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Bytes of guest output buffered before a write
+#define BOF2C_OUTPUT_BUFFER (64 * 1024)
+
+// Allocate zeroed guest memory and load the program's text and data
+// into it, as vm_load_program does
+int32_t *bof2c_start(const uint32_t *text, int32_t text_length,
+                     const int32_t *data, int32_t data_start, int32_t data_length) {
+    int32_t *mem = calloc(BOF2C_MEMORY_WORDS, sizeof(int32_t));
+    if (!mem) {
+        perror("Error allocating guest memory");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(mem, text, text_length * sizeof(uint32_t));
+    memcpy(mem + data_start, data, data_length * sizeof(int32_t));
+    setvbuf(stdout, NULL, _IOFBF, BOF2C_OUTPUT_BUFFER);
+    return mem;
+}
+
+// PSTR: print the string at addr; returns its length
+int32_t bof2c_pstr(const int32_t *mem, int32_t addr) {
+    const char *str = (const char *) &mem[addr];
+    size_t len = strlen(str);
+    fwrite(str, 1, len, stdout);
+    return (int32_t) len;
+}
+
+// PINT: print value in decimal; returns the number of characters
+int32_t bof2c_pint(int32_t value) {
+    return printf("%d", value);
+}
+
+// PCH: print the low byte of value; returns it
+int32_t bof2c_pch(int32_t value) {
+    char c = (char) value;
+    putchar(c);
+    return (unsigned char) c;
+}
+
+// RCH: read a character, or -1 at end of input, after printing what the
+// program has written so far (it may be a prompt)
+int32_t bof2c_rch(void) {
+    fflush(stdout);
+    return getchar();
+}
+
+// EXIT: stop with the given exit code
+_Noreturn void bof2c_exit(int32_t code) {
+    fflush(stdout);
+    exit(code);
+}
+
+// Stop because the instruction at pc cannot be executed
+_Noreturn void bof2c_fault(int32_t pc, const char *msg) {
+    fflush(stdout);
+    fprintf(stderr, "%s at address %d\n", msg, pc);
+    exit(EXIT_FAILURE);
+}
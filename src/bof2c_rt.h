@@ -0,0 +1,37 @@
+#ifndef BOF2C_RT_H
+#define BOF2C_RT_H
+
+// Runtime for the C that bof2c writes: guest memory, the system calls,
+// and stopping the machine. Only standard C, so a translated program
+// builds anywhere with "cc -O2 prog.c bof2c_rt.c".
+#include <stdint.h>
+
+// Words of guest memory (the VM's whole address space; the host backs
+// the pages a program touches)
+#define BOF2C_MEMORY_WORDS (1u << 28)
+
+// Guest arithmetic wraps instead of overflowing, as the VM's does (WRAP_ADD
+// and WRAP_SUB in vm.c)
+static inline int32_t bof2c_add(int32_t a, int32_t b) {
+    return (int32_t) ((uint32_t) a + (uint32_t) b);
+}
+
+static inline int32_t bof2c_sub(int32_t a, int32_t b) {
+    return (int32_t) ((uint32_t) a - (uint32_t) b);
+}
+
+static inline int32_t bof2c_neg(int32_t a) {
+    return (int32_t) (0u - (uint32_t) a);
+}
+
+// Function declarations
+int32_t *bof2c_start(const uint32_t *text, int32_t text_length,
+                     const int32_t *data, int32_t data_start, int32_t data_length);
+int32_t bof2c_pstr(const int32_t *mem, int32_t addr);
+int32_t bof2c_pint(int32_t value);
+int32_t bof2c_pch(int32_t value);
+int32_t bof2c_rch(void);
+_Noreturn void bof2c_exit(int32_t code);
+_Noreturn void bof2c_fault(int32_t pc, const char *msg);
+
+#endif // BOF2C_RT_H
@@ -0,0 +1,295 @@
+#include "callgraph.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Initial sizes of the call tree, shadow stack and symbol table (all grow as needed)
+#define CALLGRAPH_NODES 256
+#define CALLGRAPH_DEPTH 64
+#define CALLGRAPH_SYMBOLS 64
+
+// Longest symbol file line and label read
+#define CALLGRAPH_LINE 512
+
+// Double the capacity of array (or start it at CALLGRAPH_SYMBOLS)
+static void *grow(void *array, int32_t *capacity, size_t size) {
+    *capacity = *capacity ? 2 * *capacity : CALLGRAPH_SYMBOLS;
+    array = realloc(array, *capacity * size);
+    if (!array) {
+        perror("Error allocating call graph");
+        exit(EXIT_FAILURE);
+    }
+    return array;
+}
+
+// Add a node for the routine at entry, called from parent (or -1)
+static int32_t add_node(call_profile *c, int32_t entry, int32_t parent) {
+    if (c->num_nodes == c->node_capacity) {
+        c->nodes = grow(c->nodes, &c->node_capacity, sizeof(call_node));
+    }
+    int32_t n = c->num_nodes++;
+    call_node *node = &c->nodes[n];
+    node->entry = entry;
+    node->parent = parent;
+    node->child = -1;
+    node->sibling = -1;
+    node->self = 0;
+    node->calls = 1;
+    if (parent >= 0) {
+        node->sibling = c->nodes[parent].child;
+        c->nodes[parent].child = n;
+    }
+    return n;
+}
+
+// Allocate an empty profile of a program that starts at address start
+call_profile *callgraph_create(int32_t start) {
+    call_profile *c = calloc(1, sizeof(call_profile));
+    if (c) {
+        c->node_capacity = CALLGRAPH_NODES;
+        c->nodes = malloc(c->node_capacity * sizeof(call_node));
+        c->stack_capacity = CALLGRAPH_DEPTH;
+        c->stack = malloc(c->stack_capacity * sizeof(call_frame));
+    }
+    if (!c || !c->nodes || !c->stack) {
+        perror("Error allocating call graph");
+        exit(EXIT_FAILURE);
+    }
+    c->current = add_node(c, start, -1);
+    return c;
+}
+
+void callgraph_destroy(call_profile *c) {
+    if (!c) {
+        return;
+    }
+    for (int32_t i = 0; i < c->num_symbols; i++) {
+        free(c->symbols[i].name);
+    }
+    free(c->symbols);
+    free(c->nodes);
+    free(c->stack);
+    free(c);
+}
+
+// Move the shadow stack across the CALL, CSI or RTN (handler h) at addr,
+// which left the PC at next_pc. A call pushes the caller and enters the
+// callee's node under it. A return pops back to the innermost call that
+// expects it there; one no pending call expects (RTN used as a plain
+// jump) leaves the stack as it is.
+void callgraph_transfer(call_profile *c, handler_type h, int32_t addr, int32_t next_pc) {
+    if (h == RTN_H) {
+        for (int32_t i = c->depth - 1; i >= 0; i--) {
+            if (c->stack[i].return_addr == next_pc) {
+                c->current = c->stack[i].node;
+                c->depth = i;
+                return;
+            }
+        }
+        return;
+    }
+
+    if (c->depth == c->stack_capacity) {
+        c->stack = grow(c->stack, &c->stack_capacity, sizeof(call_frame));
+    }
+    c->stack[c->depth].node = c->current;
+    c->stack[c->depth].return_addr = addr + 1;
+    c->depth++;
+    int32_t n;
+    for (n = c->nodes[c->current].child; n >= 0; n = c->nodes[n].sibling) {
+        if (c->nodes[n].entry == next_pc) {
+            c->nodes[n].calls++;
+            break;
+        }
+    }
+    c->current = n >= 0 ? n : add_node(c, next_pc, c->current);
+}
+
+static int compare_symbols(const void *a, const void *b) {
+    const call_symbol *x = a, *y = b;
+    return x->addr < y->addr ? -1 : x->addr > y->addr;
+}
+
+// Load the labels in filename, a symbol table as printed by "asm -s"
+// (lines of kind, name and address; only Label lines name code)
+void callgraph_load_symbols(call_profile *c, const char *filename) {
+    FILE *f = fopen(filename, "r");
+    if (!f) {
+        perror(filename);
+        exit(EXIT_FAILURE);
+    }
+    char line[CALLGRAPH_LINE], kind[CALLGRAPH_LINE], name[CALLGRAPH_LINE];
+    int32_t addr;
+    int32_t capacity = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "%s %s %d", kind, name, &addr) != 3 || strcmp(kind, "Label") != 0) {
+            continue;
+        }
+        if (c->num_symbols == capacity) {
+            c->symbols = grow(c->symbols, &capacity, sizeof(call_symbol));
+        }
+        c->symbols[c->num_symbols].addr = addr;
+        c->symbols[c->num_symbols].name = strdup(name);
+        if (!c->symbols[c->num_symbols].name) {
+            perror("Error allocating call graph");
+            exit(EXIT_FAILURE);
+        }
+        c->num_symbols++;
+    }
+    fclose(f);
+    qsort(c->symbols, c->num_symbols, sizeof(call_symbol), compare_symbols);
+}
+
+// Print the name of the routine entered at entry on out: its label,
+// the nearest label before it plus an offset, or else its address
+static void print_routine(call_profile *c, FILE *out, int32_t entry) {
+    int32_t lo = 0, hi = c->num_symbols;
+    while (lo < hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+        if (c->symbols[mid].addr <= entry) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    //lo is now the first label after entry
+    if (lo == 0) {
+        fprintf(out, "@%d", entry);
+    } else if (c->symbols[lo - 1].addr == entry) {
+        fprintf(out, "%s", c->symbols[lo - 1].name);
+    } else {
+        fprintf(out, "%s+%d", c->symbols[lo - 1].name, entry - c->symbols[lo - 1].addr);
+    }
+}
+
+// Write the call tree to filename as folded stacks: for each call path,
+// one line naming its routines outermost first, separated by ';', then
+// the instructions run in the innermost one (the input flamegraph.pl takes)
+void callgraph_write_folded(call_profile *c, const char *filename) {
+    FILE *out = fopen(filename, "w");
+    if (!out) {
+        perror(filename);
+        exit(EXIT_FAILURE);
+    }
+    int32_t *path = malloc(c->num_nodes * sizeof(int32_t));
+    if (!path) {
+        perror("Error allocating call graph");
+        exit(EXIT_FAILURE);
+    }
+    for (int32_t i = 0; i < c->num_nodes; i++) {
+        if (c->nodes[i].self == 0) {
+            continue;
+        }
+        int32_t length = 0;
+        for (int32_t n = i; n >= 0; n = c->nodes[n].parent) {
+            path[length++] = n;
+        }
+        while (length-- > 0) {
+            print_routine(c, out, c->nodes[path[length]].entry);
+            fputc(length ? ';' : ' ', out);
+        }
+        fprintf(out, "%llu\n", (unsigned long long) c->nodes[i].self);
+    }
+    free(path);
+    if (fclose(out) != 0) {
+        perror(filename);
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Totals for one routine, over every path it was entered along
+typedef struct {
+    int32_t entry;
+    int32_t active;             // times it is on the path being walked
+    uint64_t inclusive;         // instructions run in it and its callees
+    uint64_t exclusive;         // instructions run in it alone
+    uint64_t calls;
+} routine_totals;
+
+static int compare_entries(const void *a, const void *b) {
+    const routine_totals *x = a, *y = b;
+    return x->entry < y->entry ? -1 : x->entry > y->entry;
+}
+
+static int compare_inclusive(const void *a, const void *b) {
+    const routine_totals *x = a, *y = b;
+    if (x->inclusive != y->inclusive) {
+        return x->inclusive < y->inclusive ? 1 : -1;
+    }
+    return x->entry < y->entry ? -1 : x->entry > y->entry;
+}
+
+static routine_totals *find_routine(routine_totals *r, int32_t count, int32_t entry) {
+    routine_totals key = {.entry = entry};
+    return bsearch(&key, r, count, sizeof(routine_totals), compare_entries);
+}
+
+// Print, on out, the top routines by inclusive count, with their
+// exclusive counts and how often they were called. A recursive routine's
+// inclusive count only counts its outermost activation.
+void callgraph_report(call_profile *c, FILE *out, int top) {
+    uint64_t *subtree = malloc(c->num_nodes * sizeof(uint64_t));
+    routine_totals *r = calloc(c->num_nodes, sizeof(routine_totals));
+    if (!subtree || !r) {
+        perror("Error allocating call graph report");
+        exit(EXIT_FAILURE);
+    }
+
+    //Callees always come after their callers in nodes
+    for (int32_t i = 0; i < c->num_nodes; i++) {
+        subtree[i] = c->nodes[i].self;
+        r[i].entry = c->nodes[i].entry;
+    }
+    for (int32_t i = c->num_nodes - 1; i > 0; i--) {
+        subtree[c->nodes[i].parent] += subtree[i];
+    }
+    uint64_t total = subtree[0];
+
+    qsort(r, c->num_nodes, sizeof(routine_totals), compare_entries);
+    int32_t routines = 0;
+    for (int32_t i = 0; i < c->num_nodes; i++) {
+        if (routines == 0 || r[routines - 1].entry != r[i].entry) {
+            r[routines++] = r[i];
+        }
+    }
+
+    //Walk the tree depth first, tracking which routines are on the path
+    int32_t n = 0;
+    while (n >= 0) {
+        routine_totals *t = find_routine(r, routines, c->nodes[n].entry);
+        if (t->active++ == 0) {
+            t->inclusive += subtree[n];
+        }
+        t->exclusive += c->nodes[n].self;
+        t->calls += c->nodes[n].calls;
+        if (c->nodes[n].child >= 0) {
+            n = c->nodes[n].child;
+            continue;
+        }
+        while (n >= 0) {
+            find_routine(r, routines, c->nodes[n].entry)->active--;
+            if (c->nodes[n].sibling >= 0) {
+                n = c->nodes[n].sibling;
+                break;
+            }
+            n = c->nodes[n].parent;
+        }
+    }
+
+    qsort(r, routines, sizeof(routine_totals), compare_inclusive);
+    fprintf(out, "Call graph: %llu instructions in %d routines (%d call paths)\n",
+            (unsigned long long) total, routines, c->num_nodes);
+    fprintf(out, "%12s %7s %12s %7s %10s Routine\n", "Inclusive", "%", "Exclusive", "%", "Calls");
+    for (int32_t i = 0; i < routines && i < top; i++) {
+        fprintf(out, "%12llu %6.2f%% %12llu %6.2f%% %10llu ",
+                (unsigned long long) r[i].inclusive, total ? 100.0 * r[i].inclusive / total : 0.0,
+                (unsigned long long) r[i].exclusive, total ? 100.0 * r[i].exclusive / total : 0.0,
+                (unsigned long long) r[i].calls);
+        print_routine(c, out, r[i].entry);
+        if (c->num_symbols > 0) {
+            fprintf(out, " (%d)", r[i].entry);
+        }
+        fputc('\n', out);
+    }
+    free(subtree);
+    free(r);
+}
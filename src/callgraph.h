@@ -0,0 +1,69 @@
+#ifndef CALLGRAPH_H
+#define CALLGRAPH_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "vm.h"
+
+// Does h transfer control between routines (CALL, CSI or RTN)?
+#define CALLGRAPH_IS_TRANSFER(h) ((h) == CALL_H || (h) == CSI_H || (h) == RTN_H)
+
+// One node of the call tree: a routine entered along one call path
+typedef struct {
+    int32_t entry;              // address the routine was entered at
+    int32_t parent;             // index of the caller's node, or -1 for the root
+    int32_t child;              // first routine called from here, or -1
+    int32_t sibling;            // next routine called from the parent, or -1
+    uint64_t self;              // instructions run in this routine (not its callees) on this path
+    uint64_t calls;             // times this path was entered
+} call_node;
+
+// A call still waiting for its RTN
+typedef struct {
+    int32_t node;               // the caller's node
+    int32_t return_addr;        // where the RTN should land
+} call_frame;
+
+// A label from the assembler's symbol table (asm -s)
+typedef struct {
+    int32_t addr;
+    char *name;
+} call_symbol;
+
+// Call-graph profile (vm --callgraph): a call tree built from a shadow
+// stack that CALL and CSI push and RTN pops
+typedef struct call_profile {
+    call_node *nodes;           // the tree; nodes[0] is the routine the program started in
+    int32_t num_nodes;
+    int32_t node_capacity;
+    int32_t current;            // node of the routine running now
+    call_frame *stack;          // shadow stack of pending calls
+    int32_t depth;
+    int32_t stack_capacity;
+    call_symbol *symbols;       // labels, in increasing address order
+    int32_t num_symbols;
+} call_profile;
+
+void callgraph_transfer(call_profile *c, handler_type h, int32_t addr, int32_t next_pc);
+
+// Count an instruction run in the current routine
+static inline void callgraph_count(call_profile *c) {
+    c->nodes[c->current].self++;
+}
+
+// Record that the instruction at addr, run by handler h, left the PC at next_pc
+static inline void callgraph_record(call_profile *c, handler_type h, int32_t addr, int32_t next_pc) {
+    callgraph_count(c);
+    if (CALLGRAPH_IS_TRANSFER(h)) {
+        callgraph_transfer(c, h, addr, next_pc);
+    }
+}
+
+// Function declarations
+call_profile *callgraph_create(int32_t start);
+void callgraph_destroy(call_profile *c);
+void callgraph_load_symbols(call_profile *c, const char *filename);
+void callgraph_write_folded(call_profile *c, const char *filename);
+void callgraph_report(call_profile *c, FILE *out, int top);
+
+#endif // CALLGRAPH_H
@@ -0,0 +1,222 @@
+#include "checkpoint.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CHECKPOINT_MAGIC "SSMCKPT1"
+
+// File offsets the saved pages start at are a multiple of this
+#define CHECKPOINT_ALIGN 4096
+
+#define PAGE_BYTES (VM_PAGE_WORDS * sizeof(word_type))
+
+// The start of a checkpoint file. It is followed by num_touched word
+// addresses, num_pages page numbers (in increasing order), padding to
+// CHECKPOINT_ALIGN, and the pages themselves.
+typedef struct {
+    char magic[8];
+    BOFHeader bof;
+    uint32_t memory_words;
+    int32_t pc;
+    int32_t HI;
+    int32_t LO;
+    int32_t registers[NUM_REGISTERS];
+    uint32_t tracing;
+    uint64_t steps;             // instructions run before the checkpoint
+    uint32_t num_touched;
+    uint32_t num_pages;
+} checkpoint_header;
+
+// File offset of the first saved page
+static off_t pages_offset(const checkpoint_header *h) {
+    off_t end = sizeof(checkpoint_header) + ((off_t) h->num_touched + h->num_pages) * sizeof(uint32_t);
+    return (end + CHECKPOINT_ALIGN - 1) / CHECKPOINT_ALIGN * CHECKPOINT_ALIGN;
+}
+
+static void write_or_die(FILE *f, const void *p, size_t size, const char *filename) {
+    if (size && fwrite(p, size, 1, f) != 1) {
+        perror(filename);
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Save vm, which has run steps instructions, to filename. The file is
+// written under another name and then renamed, so a run killed while
+// writing it leaves the last checkpoint whole.
+void vm_checkpoint_write(VM *vm, uint64_t steps, const char *filename) {
+    checkpoint_header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, CHECKPOINT_MAGIC, sizeof(h.magic));
+    h.bof = vm->bf_header;
+    h.memory_words = vm->memory_words;
+    h.pc = vm->pc;
+    h.HI = vm->HI;
+    h.LO = vm->LO;
+    memcpy(h.registers, vm->registers, sizeof(h.registers));
+    h.tracing = vm->tracing;
+    h.steps = steps;
+    h.num_touched = vm->num_touched;
+
+    //Pages stored into since loading; the others are all zeros
+    uint32_t *pages = NULL;
+    uint32_t capacity = 0;
+    for (int dir = 0; dir < VM_NUM_DIRS; dir++) {
+        if (!vm->dirty_dirs[dir]) {
+            continue;
+        }
+        for (int i = 0; i < VM_DIR_PAGES; i++) {
+            uint32_t page = dir * VM_DIR_PAGES + i;
+            uint32_t first = page * VM_PAGE_WORDS;
+            if (!vm->dirty_pages[page] || first >= vm->memory_words) {
+                continue;
+            }
+            const word_type *words = &vm->memory->words[first];
+            int w = 0;
+            while (w < VM_PAGE_WORDS && words[w] == 0) {
+                w++;
+            }
+            if (w == VM_PAGE_WORDS) {
+                continue;
+            }
+            if (h.num_pages == capacity) {
+                capacity = capacity ? 2 * capacity : 64;
+                pages = realloc(pages, capacity * sizeof(uint32_t));
+                if (!pages) {
+                    perror("Error allocating checkpoint");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            pages[h.num_pages++] = page;
+        }
+    }
+
+    char *temp = malloc(strlen(filename) + sizeof(".tmp"));
+    if (!temp) {
+        perror("Error allocating checkpoint");
+        exit(EXIT_FAILURE);
+    }
+    sprintf(temp, "%s.tmp", filename);
+    FILE *f = fopen(temp, "wb");
+    if (!f) {
+        perror(temp);
+        exit(EXIT_FAILURE);
+    }
+    write_or_die(f, &h, sizeof(h), temp);
+    write_or_die(f, vm->touched, h.num_touched * sizeof(int32_t), temp);
+    write_or_die(f, pages, h.num_pages * sizeof(uint32_t), temp);
+    static const char padding[CHECKPOINT_ALIGN];
+    off_t written = sizeof(h) + ((off_t) h.num_touched + h.num_pages) * sizeof(uint32_t);
+    write_or_die(f, padding, pages_offset(&h) - written, temp);
+    for (uint32_t i = 0; i < h.num_pages; i++) {
+        write_or_die(f, &vm->memory->words[pages[i] * VM_PAGE_WORDS], PAGE_BYTES, temp);
+    }
+    if (fclose(f) != 0 || rename(temp, filename) != 0) {
+        perror(temp);
+        exit(EXIT_FAILURE);
+    }
+    free(temp);
+    free(pages);
+}
+
+static void corrupt(const char *filename) {
+    fprintf(stderr, "%s: truncated or corrupt checkpoint\n", filename);
+    exit(EXIT_FAILURE);
+}
+
+// Read size bytes at offset of fd into p
+static void read_at(int fd, void *p, size_t size, off_t offset, const char *filename) {
+    while (size > 0) {
+        ssize_t n = pread(fd, p, size, offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            corrupt(filename);
+        }
+        p = (char *) p + n;
+        size -= n;
+        offset += n;
+    }
+}
+
+// Put the machine saved in filename into vm, a VM fresh from vm_init (in
+// place of vm_load_program); returns the instructions it had run. Runs
+// of consecutive pages are mapped copy-on-write from the file when the
+// host's page size allows, and read otherwise.
+uint64_t vm_checkpoint_restore(VM *vm, const char *filename) {
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        perror(filename);
+        exit(EXIT_FAILURE);
+    }
+    checkpoint_header h;
+    if (st.st_size < (off_t) sizeof(h)) {
+        corrupt(filename);
+    }
+    read_at(fd, &h, sizeof(h), 0, filename);
+    if (memcmp(h.magic, CHECKPOINT_MAGIC, sizeof(h.magic)) != 0) {
+        fprintf(stderr, "%s: not a checkpoint\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    if (h.memory_words != vm->memory_words) {
+        vm_set_memory_words(vm, h.memory_words);
+    }
+    if (h.bof.text_length < 0 || (uint32_t) h.bof.text_length > vm->memory_words
+        || h.num_touched > vm->memory_words || h.num_pages > vm->memory_words / VM_PAGE_WORDS
+        || st.st_size < pages_offset(&h) + (off_t) h.num_pages * (off_t) PAGE_BYTES) {
+        corrupt(filename);
+    }
+    int32_t *touched = malloc(((size_t) h.num_touched + 1) * sizeof(int32_t));
+    uint32_t *pages = malloc(((size_t) h.num_pages + 1) * sizeof(uint32_t));
+    if (!touched || !pages) {
+        perror("Error allocating checkpoint");
+        exit(EXIT_FAILURE);
+    }
+    read_at(fd, touched, h.num_touched * sizeof(int32_t), sizeof(h), filename);
+    read_at(fd, pages, h.num_pages * sizeof(uint32_t), sizeof(h) + h.num_touched * sizeof(int32_t), filename);
+
+    long host_page = sysconf(_SC_PAGESIZE);
+    bool can_map = host_page > 0 && CHECKPOINT_ALIGN % host_page == 0 && PAGE_BYTES % host_page == 0
+                   && (uintptr_t) vm->memory % host_page == 0;
+    off_t offset = pages_offset(&h);
+    for (uint32_t i = 0, run; i < h.num_pages; i += run) {
+        for (run = 1; i + run < h.num_pages && pages[i + run] == pages[i] + run; run++) {
+        }
+        if (pages[i] + run > vm->memory_words / VM_PAGE_WORDS || (i > 0 && pages[i] <= pages[i - 1])) {
+            corrupt(filename);
+        }
+        word_type *dest = &vm->memory->words[pages[i] * VM_PAGE_WORDS];
+        size_t size = run * PAGE_BYTES;
+        off_t at = offset + (off_t) i * PAGE_BYTES;
+        if (!can_map || mmap(dest, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, at) == MAP_FAILED) {
+            read_at(fd, dest, size, at, filename);
+        }
+        for (uint32_t p = pages[i]; p < pages[i] + run; p++) {
+            VM_MARK_DIRTY(vm, p * VM_PAGE_WORDS);
+        }
+    }
+    close(fd);
+
+    vm->bf_header = h.bof;
+    vm->program_size = h.bof.text_length;
+    vm->pc = h.pc;
+    vm->HI = h.HI;
+    vm->LO = h.LO;
+    memcpy(vm->registers, h.registers, sizeof(vm->registers));
+    vm->tracing = h.tracing != 0;
+    vm->retired = h.steps;
+    //Saved in increasing order, so each one goes on the end of the list
+    for (uint32_t i = 0; i < h.num_touched; i++) {
+        vm_touch(vm, touched[i]);
+    }
+    vm_decode_text(vm);
+    free(touched);
+    free(pages);
+    return h.steps;
+}
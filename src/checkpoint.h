@@ -0,0 +1,19 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "vm.h"
+
+// A running machine saved to a file (vm --checkpoint-every), to carry on
+// from later (vm --restore) on the same kind of host. The file holds the
+// registers, HI/LO, the PC, the program's BOF header, the tracing flag,
+// the words print_words lists, and every page stored into since the
+// program was loaded that isn't all zeros. The pages start at a host page
+// boundary so a restore can map them straight into guest memory.
+// Guest input isn't saved: a restored program reads on from its new stdin,
+// or from the reads after the checkpoint in an input log (vm --replay).
+
+// Function declarations
+void vm_checkpoint_write(VM *vm, uint64_t steps, const char *filename);
+uint64_t vm_checkpoint_restore(VM *vm, const char *filename);
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,526 @@
+#include "debugger.h"
+#include "guest_io.h"
+#include "trace.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+
+// A page of guest memory as a snapshot saved it, shared by the later
+// snapshots that didn't store into it
+typedef struct saved_page {
+    int refs;
+    word_type words[VM_PAGE_WORDS];
+} saved_page;
+
+// One directory entry's saved pages (NULL where a page was all zeros),
+// shared by the snapshots that didn't store anywhere under it
+typedef struct saved_dir {
+    int refs;
+    saved_page *pages[VM_DIR_PAGES];
+} saved_dir;
+
+typedef struct {
+    uint64_t step;              // instructions retired when it was taken
+    int32_t pc;
+    int32_t HI;
+    int32_t LO;
+    int32_t registers[NUM_REGISTERS];
+    bool tracing;
+    int32_t *touched;
+    int32_t num_touched;
+    saved_dir *dirs[VM_NUM_DIRS];
+} debug_snapshot;
+
+// A store in the write log
+typedef struct {
+    uint64_t step;              // the step that stored
+    int32_t addr;
+    word_type old;              // the word it stored over
+} write_record;
+
+typedef struct {
+    VM *vm;
+    uint64_t interval;
+    uint64_t first;             // step of the first snapshot
+    debug_snapshot **snaps;     // snapshot i is at step first + i * interval
+    size_t num_snaps;
+    size_t snaps_capacity;
+    size_t base;                // guest memory is this snapshot's but for the dirty pages
+    uint64_t furthest;          // most steps run so far; output and stores past it are new
+    uint64_t saved_pages;       // pages held by all the snapshots together
+    write_record *writes;       // ring of DEBUG_WRITE_LOG stores, oldest overwritten first
+    size_t num_writes;
+    size_t next_write;
+    FILE *out;                  // where guest output goes when it is new
+    FILE *null_out;             // where it goes when it was printed before
+    FILE *null_in;              // guest input when no log is replayed
+} debugger;
+
+static void *debug_alloc(size_t size) {
+    void *p = calloc(1, size);
+    if (!p) {
+        perror("Error allocating debugger");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+// Print to the VM's trace buffer, after the guest output so far
+static void say(debugger *db, const char *format, ...) {
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    trace_str(db->vm->trace, line);
+}
+
+static void release_page(debugger *db, saved_page *p) {
+    if (p && --p->refs == 0) {
+        free(p);
+        db->saved_pages--;
+    }
+}
+
+static void release_dir(debugger *db, saved_dir *d) {
+    if (!d || --d->refs > 0) {
+        return;
+    }
+    for (int i = 0; i < VM_DIR_PAGES; i++) {
+        release_page(db, d->pages[i]);
+    }
+    free(d);
+}
+
+// Copy the page starting at guest address first, or return NULL if it is
+// all zeros
+static saved_page *save_page(debugger *db, uint32_t first) {
+    const word_type *words = &db->vm->memory->words[first];
+    int w = 0;
+    while (w < VM_PAGE_WORDS && words[w] == 0) {
+        w++;
+    }
+    if (w == VM_PAGE_WORDS) {
+        return NULL;
+    }
+    saved_page *p = debug_alloc(sizeof(saved_page));
+    p->refs = 1;
+    memcpy(p->words, words, sizeof(p->words));
+    db->saved_pages++;
+    return p;
+}
+
+static void clear_dirty(VM *vm) {
+    for (int dir = 0; dir < VM_NUM_DIRS; dir++) {
+        if (vm->dirty_dirs[dir]) {
+            memset(&vm->dirty_pages[dir * VM_DIR_PAGES], 0, VM_DIR_PAGES);
+            vm->dirty_dirs[dir] = 0;
+        }
+    }
+}
+
+// Snapshot the machine, sharing the base snapshot's pages and directory
+// entries except where there are dirty pages, and make it the base
+static void take_snapshot(debugger *db) {
+    VM *vm = db->vm;
+    debug_snapshot *snap = debug_alloc(sizeof(debug_snapshot));
+    snap->step = vm->retired;
+    snap->pc = vm->pc;
+    snap->HI = vm->HI;
+    snap->LO = vm->LO;
+    memcpy(snap->registers, vm->registers, sizeof(snap->registers));
+    snap->tracing = vm->tracing;
+    snap->num_touched = vm->num_touched;
+    snap->touched = debug_alloc((vm->num_touched > 0 ? vm->num_touched : 1) * sizeof(int32_t));
+    memcpy(snap->touched, vm->touched, vm->num_touched * sizeof(int32_t));
+
+    const debug_snapshot *prev = db->num_snaps ? db->snaps[db->base] : NULL;
+    for (int dir = 0; dir < VM_NUM_DIRS; dir++) {
+        saved_dir *d = prev ? prev->dirs[dir] : NULL;
+        if (!vm->dirty_dirs[dir]) {
+            if (d) {
+                d->refs++;
+            }
+            snap->dirs[dir] = d;
+            continue;
+        }
+        saved_dir *copy = debug_alloc(sizeof(saved_dir));
+        copy->refs = 1;
+        if (d) {
+            memcpy(copy->pages, d->pages, sizeof(copy->pages));
+            for (int i = 0; i < VM_DIR_PAGES; i++) {
+                if (copy->pages[i]) {
+                    copy->pages[i]->refs++;
+                }
+            }
+        }
+        for (int i = 0; i < VM_DIR_PAGES; i++) {
+            uint32_t page = dir * VM_DIR_PAGES + i;
+            uint32_t first = page * VM_PAGE_WORDS;
+            if (!vm->dirty_pages[page]) {
+                continue;
+            }
+            vm->dirty_pages[page] = 0;
+            if (first < vm->memory_words) {
+                release_page(db, copy->pages[i]);
+                copy->pages[i] = save_page(db, first);
+            }
+        }
+        vm->dirty_dirs[dir] = 0;
+        snap->dirs[dir] = copy;
+    }
+
+    if (db->num_snaps == db->snaps_capacity) {
+        db->snaps_capacity = db->snaps_capacity ? 2 * db->snaps_capacity : 64;
+        db->snaps = realloc(db->snaps, db->snaps_capacity * sizeof(debug_snapshot *));
+        if (!db->snaps) {
+            perror("Error allocating debugger");
+            exit(EXIT_FAILURE);
+        }
+    }
+    db->base = db->num_snaps;
+    db->snaps[db->num_snaps++] = snap;
+}
+
+// Copy a page back from a snapshot (NULL for all zeros). Text words that
+// change are decoded again through vm_text_written.
+static void restore_page(VM *vm, const saved_page *saved, uint32_t page) {
+    uint32_t first = page * VM_PAGE_WORDS;
+    if (first >= vm->memory_words) {
+        return;
+    }
+    for (uint32_t addr = first; addr < first + VM_PAGE_WORDS && addr < (uint32_t) vm->program_size; addr++) {
+        word_type word = saved ? saved->words[addr - first] : 0;
+        if (vm->memory->words[addr] != word) {
+            vm->memory->words[addr] = word;
+            vm_text_written(vm, addr);
+        }
+    }
+    if (saved) {
+        memcpy(&vm->memory->words[first], saved->words, sizeof(saved->words));
+    } else {
+        memset(&vm->memory->words[first], 0, VM_PAGE_WORDS * sizeof(word_type));
+    }
+}
+
+static const saved_page *page_of(const saved_dir *d, int i) {
+    return d ? d->pages[i] : NULL;
+}
+
+// Put the machine back as snapshot j has it. Only pages that are dirty,
+// or that differ between snapshot j and the base, are copied.
+static void restore_snapshot(debugger *db, size_t j) {
+    VM *vm = db->vm;
+    const debug_snapshot *snap = db->snaps[j];
+    const debug_snapshot *cur = db->snaps[db->base];
+    for (int dir = 0; dir < VM_NUM_DIRS; dir++) {
+        if (!vm->dirty_dirs[dir] && snap->dirs[dir] == cur->dirs[dir]) {
+            continue;
+        }
+        for (int i = 0; i < VM_DIR_PAGES; i++) {
+            uint32_t page = dir * VM_DIR_PAGES + i;
+            if (vm->dirty_pages[page] || page_of(snap->dirs[dir], i) != page_of(cur->dirs[dir], i)) {
+                restore_page(vm, page_of(snap->dirs[dir], i), page);
+                vm->dirty_pages[page] = 0;
+            }
+        }
+        vm->dirty_dirs[dir] = 0;
+    }
+
+    vm->pc = snap->pc;
+    vm->HI = snap->HI;
+    vm->LO = snap->LO;
+    memcpy(vm->registers, snap->registers, sizeof(vm->registers));
+    vm->tracing = snap->tracing;
+    vm->retired = snap->step;
+    vm->state = VM_RUNNING;
+    vm->exit_code = 0;
+    vm->fault_pc = 0;
+    vm->fault_msg = NULL;
+
+    //As in vm_snapshot_restore: the bitmap's leaves are never freed, so
+    //clearing the current words' bits and setting the snapshot's will do.
+    for (int i = 0; i < vm->num_touched; i++) {
+        int32_t addr = vm->touched[i];
+        vm->touched_bits[addr >> VM_DIR_SHIFT][(addr & (VM_DIR_WORDS - 1)) / 64] &= ~(1ULL << (addr % 64));
+    }
+    for (int i = 0; i < snap->num_touched; i++) {
+        int32_t addr = snap->touched[i];
+        vm->touched_bits[addr >> VM_DIR_SHIFT][(addr & (VM_DIR_WORDS - 1)) / 64] |= 1ULL << (addr % 64);
+    }
+    memcpy(vm->touched, snap->touched, snap->num_touched * sizeof(int32_t));
+    vm->num_touched = snap->num_touched;
+
+    if (vm->in->replay) {
+        guest_input_seek(vm->in, snap->step);
+    }
+    db->base = j;
+}
+
+// At a snapshot's step, take it the first time and make it the base after
+// that (running again from an earlier one left memory just as it was)
+static void at_step(debugger *db) {
+    uint64_t since = db->vm->retired - db->first;
+    if (since % db->interval != 0) {
+        return;
+    }
+    size_t n = since / db->interval;
+    if (n == db->num_snaps) {
+        take_snapshot(db);
+    } else if (n < db->num_snaps) {
+        db->base = n;
+        clear_dirty(db->vm);
+    }
+}
+
+// Log the store the next instruction is about to make
+static void log_write(debugger *db) {
+    VM *vm = db->vm;
+    int32_t addr;
+    if (!vm_store_target(vm, &addr) || (uint32_t) addr >= vm->memory_words) {
+        return;
+    }
+    write_record *w = &db->writes[db->next_write];
+    w->step = vm->retired + 1;
+    w->addr = addr;
+    w->old = vm->memory->words[addr];
+    db->next_write = (db->next_write + 1) % DEBUG_WRITE_LOG;
+    if (db->num_writes < DEBUG_WRITE_LOG) {
+        db->num_writes++;
+    }
+}
+
+static void step_one(debugger *db) {
+    VM *vm = db->vm;
+    at_step(db);
+    bool is_new = vm->retired >= db->furthest;
+    if (is_new) {
+        log_write(db);
+    }
+    vm_execute(vm, 1);
+    if (vm->retired > db->furthest) {
+        db->furthest = vm->retired;
+    } else if (is_new && vm->state == VM_FAULTED && db->num_writes > 0
+               && db->writes[(db->next_write + DEBUG_WRITE_LOG - 1) % DEBUG_WRITE_LOG].step == vm->retired + 1) {
+        //The faulting instruction didn't store after all
+        db->next_write = (db->next_write + DEBUG_WRITE_LOG - 1) % DEBUG_WRITE_LOG;
+        db->num_writes--;
+    }
+}
+
+// Run on until target steps have been retired or the machine stops,
+// without printing guest output again up to the furthest step run before
+static void run_forward(debugger *db, uint64_t target) {
+    VM *vm = db->vm;
+    while (vm->retired < target && vm->state == VM_RUNNING) {
+        bool again = vm->retired < db->furthest;
+        uint64_t stop = again && db->furthest < target ? db->furthest : target;
+        if (again) {
+            vm_set_output(vm, db->null_out);
+        }
+        while (vm->retired < stop && vm->state == VM_RUNNING) {
+            step_one(db);
+        }
+        if (again) {
+            vm_set_output(vm, db->out);
+        }
+    }
+}
+
+// Take the machine to the state after target steps (or the step it
+// stopped at, if it stops before), from the nearest snapshot at or
+// before target unless running on from here is as quick
+static void go_to(debugger *db, uint64_t target) {
+    VM *vm = db->vm;
+    if (target < db->first) {
+        target = db->first;
+    }
+    uint64_t n = (target - db->first) / db->interval;
+    size_t j = n < db->num_snaps ? (size_t) n : db->num_snaps - 1;
+    if (target < vm->retired || (vm->state == VM_RUNNING && db->snaps[j]->step > vm->retired)) {
+        restore_snapshot(db, j);
+    }
+    run_forward(db, target);
+}
+
+// Go back to just before the last store to addr at or before this step
+static void back_to_write(debugger *db, int32_t addr) {
+    uint64_t now = db->vm->retired;
+    for (size_t k = 0; k < db->num_writes; k++) {
+        const write_record *w = &db->writes[(db->next_write + DEBUG_WRITE_LOG - 1 - k) % DEBUG_WRITE_LOG];
+        if (w->step <= now && w->addr == addr) {
+            uint64_t step = w->step;
+            word_type old = w->old;
+            go_to(db, step - 1);
+            say(db, "step %llu stores to %d over %d\n", (unsigned long long) step, addr, old);
+            return;
+        }
+    }
+    if (db->num_writes == DEBUG_WRITE_LOG) {
+        say(db, "no store to %d in the last %d logged\n", addr, DEBUG_WRITE_LOG);
+    } else {
+        say(db, "no store to %d before this step\n", addr);
+    }
+}
+
+// Print the step and the instruction to run next, or how the machine stopped
+static void where(debugger *db) {
+    VM *vm = db->vm;
+    say(db, "step %llu", (unsigned long long) vm->retired);
+    if (vm->state == VM_EXITED) {
+        say(db, ": exited with code %d\n", vm->exit_code);
+    } else if (vm->state == VM_FAULTED) {
+        say(db, ": %s at address %d\n", vm->fault_msg, vm->fault_pc);
+    } else {
+        trace_char(vm->trace, '\n');
+        print_instruction(vm, vm->pc);
+    }
+}
+
+static void help(debugger *db) {
+    say(db, "step [N]         run N instructions (default 1)\n");
+    say(db, "back [N]         go back N instructions (default 1)\n");
+    say(db, "goto N           go to the state after N instructions\n");
+    say(db, "continue         run until the program stops\n");
+    say(db, "last-write ADDR  go back to just before the last store to ADDR\n");
+    say(db, "print            print the registers and the words the trace lists\n");
+    say(db, "x ADDR [N]       print N words from ADDR (default 1)\n");
+    say(db, "where            print the step and the next instruction\n");
+    say(db, "info             print the snapshots and logged stores held\n");
+    say(db, "quit\n");
+}
+
+// Parse a number argument, which must be there if required
+static bool number(const char *arg, bool required, long long min, long long *value) {
+    if (!arg) {
+        return !required;
+    }
+    char *end;
+    long long v = strtoll(arg, &end, 0);
+    if (end == arg || *end || v < min) {
+        return false;
+    }
+    *value = v;
+    return true;
+}
+
+// Run the debugger on vm, a program just loaded (or restored), reading
+// commands from commands until quit or the end of the stream, and taking
+// a snapshot every interval steps
+int vm_debug(VM *vm, uint64_t interval, FILE *commands) {
+    debugger db;
+    memset(&db, 0, sizeof(db));
+    db.vm = vm;
+    db.interval = interval;
+    db.first = vm->retired;
+    db.furthest = vm->retired;
+    db.writes = debug_alloc(DEBUG_WRITE_LOG * sizeof(write_record));
+    db.out = vm->trace->out;
+    db.null_out = fopen("/dev/null", "w");
+    if (!db.null_out) {
+        perror("/dev/null");
+        exit(EXIT_FAILURE);
+    }
+    if (!vm->in->replay) {
+        db.null_in = fopen("/dev/null", "r");
+        if (!db.null_in) {
+            perror("/dev/null");
+            exit(EXIT_FAILURE);
+        }
+        guest_input_set(vm->in, db.null_in);
+    }
+    vm->tracing = false;
+    at_step(&db);
+
+    bool interactive = isatty(fileno(commands));
+    where(&db);
+    char line[256];
+    for (;;) {
+        if (interactive) {
+            trace_str(vm->trace, "(ssm) ");
+        }
+        guest_output_flush(vm->trace);
+        if (!fgets(line, sizeof(line), commands)) {
+            break;
+        }
+        char *cmd = strtok(line, " \t\r\n");
+        char *arg1 = cmd ? strtok(NULL, " \t\r\n") : NULL;
+        char *arg2 = arg1 ? strtok(NULL, " \t\r\n") : NULL;
+        long long n = 1, addr = 0;
+        if (!cmd) {
+            continue;
+        } else if (strcmp(cmd, "step") == 0 || strcmp(cmd, "s") == 0) {
+            if (!number(arg1, false, 0, &n)) {
+                say(&db, "usage: step [N]\n");
+                continue;
+            }
+            go_to(&db, vm->retired + n);
+            where(&db);
+        } else if (strcmp(cmd, "back") == 0 || strcmp(cmd, "b") == 0) {
+            if (!number(arg1, false, 0, &n)) {
+                say(&db, "usage: back [N]\n");
+                continue;
+            }
+            go_to(&db, (uint64_t) n < vm->retired ? vm->retired - n : 0);
+            where(&db);
+        } else if (strcmp(cmd, "goto") == 0 || strcmp(cmd, "g") == 0) {
+            if (!number(arg1, true, 0, &n)) {
+                say(&db, "usage: goto N\n");
+                continue;
+            }
+            go_to(&db, n);
+            where(&db);
+        } else if (strcmp(cmd, "continue") == 0 || strcmp(cmd, "c") == 0) {
+            go_to(&db, UINT64_MAX);
+            where(&db);
+        } else if (strcmp(cmd, "last-write") == 0 || strcmp(cmd, "w") == 0) {
+            if (!number(arg1, true, 0, &addr) || addr >= vm->memory_words) {
+                say(&db, "usage: last-write ADDR\n");
+                continue;
+            }
+            back_to_write(&db, (int32_t) addr);
+            where(&db);
+        } else if (strcmp(cmd, "print") == 0 || strcmp(cmd, "p") == 0) {
+            print_registers(vm);
+            print_words(vm);
+        } else if (strcmp(cmd, "x") == 0) {
+            if (!number(arg1, true, 0, &addr) || !number(arg2, false, 1, &n) || addr >= vm->memory_words) {
+                say(&db, "usage: x ADDR [N]\n");
+                continue;
+            }
+            for (long long a = addr; a < addr + n && a < vm->memory_words; a++) {
+                say(&db, "%8lld: %d\n", a, vm->memory->words[a]);
+            }
+        } else if (strcmp(cmd, "where") == 0) {
+            where(&db);
+        } else if (strcmp(cmd, "info") == 0) {
+            say(&db, "%zu snapshots, every %llu steps, holding %llu pages\n", db.num_snaps,
+                (unsigned long long) db.interval, (unsigned long long) db.saved_pages);
+            say(&db, "%zu stores logged\n", db.num_writes);
+        } else if (strcmp(cmd, "help") == 0 || strcmp(cmd, "h") == 0) {
+            help(&db);
+        } else if (strcmp(cmd, "quit") == 0 || strcmp(cmd, "q") == 0) {
+            break;
+        } else {
+            say(&db, "unknown command %s (try help)\n", cmd);
+        }
+    }
+    guest_output_flush(vm->trace);
+
+    for (size_t i = 0; i < db.num_snaps; i++) {
+        for (int dir = 0; dir < VM_NUM_DIRS; dir++) {
+            release_dir(&db, db.snaps[i]->dirs[dir]);
+        }
+        free(db.snaps[i]->touched);
+        free(db.snaps[i]);
+    }
+    free(db.snaps);
+    free(db.writes);
+    fclose(db.null_out);
+    if (db.null_in) {
+        guest_input_set(vm->in, stdin);
+        fclose(db.null_in);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,28 @@
+#ifndef DEBUGGER_H
+#define DEBUGGER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "vm.h"
+
+// Reverse-execution debugger (vm --debug). The program runs one step at a
+// time under commands read from a stream, and can be taken back as well as
+// forward: every interval steps the machine is snapshotted, and a ring of
+// (step, address, old value) records logs the last DEBUG_WRITE_LOG stores.
+// Going to any step restores the nearest snapshot at or before it and runs
+// on from there, at most interval steps. Snapshots share the pages that
+// didn't change between them, so each costs only the pages stored into
+// since the one before. Guest input must come from a --replay log (or
+// is empty), so running a stretch again reads the same bytes; guest output
+// is only printed the first time the program gets that far.
+
+// Steps between snapshots, unless vm --snapshot-every says otherwise
+#define DEBUG_SNAPSHOT_INTERVAL 10000
+
+// Stores the write log holds
+#define DEBUG_WRITE_LOG (1 << 16)
+
+// Function declarations
+int vm_debug(VM *vm, uint64_t interval, FILE *commands);
+
+#endif // DEBUGGER_H
@@ -0,0 +1,227 @@
+#include "guest_io.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+// Make RCH read from in
+guest_input *guest_input_create(FILE *in) {
+    guest_input *gi = calloc(1, sizeof(guest_input));
+    if (!gi) {
+        perror("Error allocating guest input");
+        exit(EXIT_FAILURE);
+    }
+    gi->in = in;
+    return gi;
+}
+
+void guest_input_destroy(guest_input *gi) {
+    if (!gi) {
+        return;
+    }
+    if (gi->record && fclose(gi->record) != 0) {
+        perror("Error writing input log");
+        exit(EXIT_FAILURE);
+    }
+    free(gi->replay);
+    free(gi->buf);
+    free(gi);
+}
+
+// Read from in from now on, dropping what was read ahead of the old stream
+// and any log being replayed
+void guest_input_set(guest_input *gi, FILE *in) {
+    gi->in = in;
+    gi->pos = 0;
+    gi->len = 0;
+    free(gi->replay);
+    gi->replay = NULL;
+}
+
+// Refill the buffer and return its first byte, or EOF. A stream with a
+// descriptor is read with read(), which returns what is there rather
+// than waiting for a whole buffer, so an interactive guest sees each
+// line as it is typed.
+int guest_input_fill(guest_input *gi) {
+    if (!gi->buf) {
+        gi->buf = malloc(GUEST_INPUT_SIZE);
+        if (!gi->buf) {
+            perror("Error allocating guest input");
+            exit(EXIT_FAILURE);
+        }
+    }
+    gi->pos = 0;
+    gi->len = 0;
+    //What has been logged so far is kept if the run is killed while waiting
+    if (gi->record) {
+        fflush(gi->record);
+    }
+    int fd = fileno(gi->in);
+    if (fd < 0) {
+        gi->len = fread(gi->buf, 1, GUEST_INPUT_SIZE, gi->in);
+    } else {
+        ssize_t n;
+        do {
+            n = read(fd, gi->buf, GUEST_INPUT_SIZE);
+        } while (n < 0 && errno == EINTR);
+        gi->len = n > 0 ? (size_t) n : 0;
+    }
+    if (gi->len == 0) {
+        return EOF;
+    }
+    return gi->buf[gi->pos++];
+}
+
+// Log every read from now on to filename
+void guest_input_record(guest_input *gi, const char *filename) {
+    gi->record = fopen(filename, "wb");
+    if (!gi->record) {
+        perror(filename);
+        exit(EXIT_FAILURE);
+    }
+    fwrite(GUEST_LOG_MAGIC, 1, sizeof(GUEST_LOG_MAGIC) - 1, gi->record);
+    gi->log_step = 0;
+}
+
+// Decode the record at gi->replay_pos into *steps (since the last read)
+// and *c. Returns false at the end of the log or a truncated record.
+static bool replay_next(guest_input *gi, uint64_t *steps, int *c) {
+    uint64_t v = 0;
+    size_t pos = gi->replay_pos;
+    for (int shift = 0; ; shift += 7) {
+        if (pos == gi->replay_len || shift > 63) {
+            return false;
+        }
+        unsigned char b = gi->replay[pos++];
+        v |= (uint64_t) (b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            break;
+        }
+    }
+    if (v & 1) {
+        *c = EOF;
+    } else if (pos == gi->replay_len) {
+        return false;
+    } else {
+        *c = gi->replay[pos++];
+    }
+    gi->replay_pos = pos;
+    *steps = v >> 1;
+    return true;
+}
+
+// Feed reads from the log in filename instead of the stream, starting with
+// the first one after step (the steps a restored checkpoint had run).
+// The log is read in whole up front. Returns false, leaving gi as it was,
+// if filename isn't an input log.
+bool guest_input_replay(guest_input *gi, const char *filename, uint64_t step) {
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        perror(filename);
+        exit(EXIT_FAILURE);
+    }
+    unsigned char *log = malloc(st.st_size > 0 ? (size_t) st.st_size : 1);
+    if (!log) {
+        perror("Error allocating input log");
+        exit(EXIT_FAILURE);
+    }
+    size_t len = 0;
+    while (len < (size_t) st.st_size) {
+        ssize_t n = read(fd, log + len, st.st_size - len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            perror(filename);
+            exit(EXIT_FAILURE);
+        }
+        if (n == 0) {
+            break;
+        }
+        len += n;
+    }
+    close(fd);
+    size_t magic = sizeof(GUEST_LOG_MAGIC) - 1;
+    if (len < magic || memcmp(log, GUEST_LOG_MAGIC, magic) != 0) {
+        free(log);
+        return false;
+    }
+
+    free(gi->replay);
+    gi->replay = log;
+    gi->replay_len = len;
+    guest_input_seek(gi, step);
+    return true;
+}
+
+// Go back or ahead in the log being replayed to the first read after step
+void guest_input_seek(guest_input *gi, uint64_t step) {
+    gi->replay_pos = sizeof(GUEST_LOG_MAGIC) - 1;
+    gi->log_step = 0;
+    for (;;) {
+        size_t at = gi->replay_pos;
+        uint64_t steps;
+        int c;
+        if (!replay_next(gi, &steps, &c) || gi->log_step + steps > step) {
+            gi->replay_pos = at;
+            break;
+        }
+        gi->log_step += steps;
+    }
+}
+
+// RCH at step (counting from the start of the program) when logging:
+// read *c and log it, or take it from the log being replayed. Returns
+// false if the log has no read at step, when the replayed run has gone
+// a different way from the recorded one.
+bool guest_input_logged(guest_input *gi, uint64_t step, int *c) {
+    if (gi->replay) {
+        size_t at = gi->replay_pos;
+        uint64_t steps;
+        if (!replay_next(gi, &steps, c) || gi->log_step + steps != step) {
+            gi->replay_pos = at;
+            return false;
+        }
+        gi->log_step = step;
+        return true;
+    }
+    *c = guest_getc(gi);
+    uint64_t v = (step - gi->log_step) << 1 | (*c == EOF);
+    while (v >= 0x80) {
+        putc((int) (v & 0x7f) | 0x80, gi->record);
+        v >>= 7;
+    }
+    putc((int) v, gi->record);
+    if (*c != EOF) {
+        putc(*c, gi->record);
+    }
+    gi->log_step = step;
+    return true;
+}
+
+// Append the NUL-terminated guest string s, reading at most max bytes of
+// it, in one pass that copies as it looks for the end; returns its length
+size_t guest_write_str(trace_buffer *tb, const char *s, size_t max) {
+    size_t n = 0;
+    while (n < max) {
+        if (tb->len == TRACE_BUFFER_SIZE) {
+            trace_drain(tb);
+        }
+        size_t room = TRACE_BUFFER_SIZE - tb->len;
+        if (room > max - n) {
+            room = max - n;
+        }
+        char *end = memccpy(tb->buf + tb->len, s + n, '\0', room);
+        if (end) {
+            size_t copied = end - (tb->buf + tb->len) - 1;
+            tb->len += copied;
+            return n + copied;
+        }
+        tb->len += room;
+        n += room;
+    }
+    return n;
+}
@@ -0,0 +1,68 @@
+#ifndef GUEST_IO_H
+#define GUEST_IO_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "trace.h"
+
+// Guest I/O for the PSTR, PINT, PCH and RCH system calls. Output goes
+// into the VM's trace buffer, in order with the trace, and is written in
+// large blocks; input is read ahead in large blocks.
+//
+// RCH's input can also be logged (vm --record), each read with the step it
+// happened at, and fed back from the log (vm --replay) with no stream at
+// all. A log is GUEST_LOG_MAGIC and then one record per read: a varint
+// holding the steps since the last read shifted left once, with the low
+// bit set for an EOF, followed (unless it was EOF) by the byte read.
+
+// Bytes of guest input read at a time
+#define GUEST_INPUT_SIZE (64 * 1024)
+
+#define GUEST_LOG_MAGIC "SSMINLG1"
+
+// Where RCH reads from, with what has been read ahead of it
+typedef struct guest_input {
+    FILE *in;
+    unsigned char *buf;         // GUEST_INPUT_SIZE bytes, allocated on the first read
+    size_t pos;                 // next byte of buf to return
+    size_t len;                 // bytes in buf
+    FILE *record;               // input log being written, or NULL
+    unsigned char *replay;      // input log being read instead of in, or NULL
+    size_t replay_pos;          // next record of replay
+    size_t replay_len;
+    uint64_t log_step;          // step of the last read logged or replayed
+} guest_input;
+
+// Function declarations
+guest_input *guest_input_create(FILE *in);
+void guest_input_destroy(guest_input *gi);
+void guest_input_set(guest_input *gi, FILE *in);
+int guest_input_fill(guest_input *gi);
+void guest_input_record(guest_input *gi, const char *filename);
+bool guest_input_replay(guest_input *gi, const char *filename, uint64_t step);
+void guest_input_seek(guest_input *gi, uint64_t step);
+bool guest_input_logged(guest_input *gi, uint64_t step, int *c);
+size_t guest_write_str(trace_buffer *tb, const char *s, size_t max);
+
+// Return the next input byte, or EOF
+static inline int guest_getc(guest_input *gi) {
+    if (gi->pos < gi->len) {
+        return gi->buf[gi->pos++];
+    }
+    return guest_input_fill(gi);
+}
+
+// Whether RCH goes through guest_input_logged rather than guest_getc
+static inline bool guest_input_logging(const guest_input *gi) {
+    return gi->record || gi->replay;
+}
+
+// Write out everything buffered so far, through the stream as well (so a
+// prompt is seen before the guest reads its answer)
+static inline void guest_output_flush(trace_buffer *tb) {
+    trace_flush(tb);
+    fflush(tb->out);
+}
+
+#endif // GUEST_IO_H
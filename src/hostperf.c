@@ -0,0 +1,253 @@
+#include "hostperf.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Empty sample windows timed to find the cost of a window itself
+#define HOST_CALIBRATION_WINDOWS 64
+
+static const char *event_names[NUM_HOST_EVENTS] = {
+    "cycles", "instructions", "branch-misses", "L1D read misses", "task-clock (ns)"
+};
+
+#ifdef __linux__
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} events[NUM_HOST_EVENTS] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                         | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+};
+
+// A group read: PERF_FORMAT_GROUP with both times
+typedef struct {
+    uint64_t nr;
+    uint64_t time_enabled;
+    uint64_t time_running;
+    uint64_t values[NUM_HOST_EVENTS];
+} group_read;
+
+// Read the group's counts into counts (0 for events not counted);
+// returns false if the read failed
+static bool read_group(host_counters *h, group_read *g, uint64_t counts[NUM_HOST_EVENTS]) {
+    if (read(h->leader, g, sizeof(*g)) < (ssize_t) (3 + h->num_open) * (ssize_t) sizeof(uint64_t)) {
+        return false;
+    }
+    for (int e = 0; e < NUM_HOST_EVENTS; e++) {
+        counts[e] = h->fd[e] >= 0 ? g->values[h->slot[e]] : 0;
+    }
+    return true;
+}
+#endif
+
+// Open a group of the host events this process may count (user space
+// only, so the paranoid level doesn't matter below 3). Events that can't
+// be opened are left out; if none can, the run goes ahead uncounted.
+// With sample_period nonzero, single guest instructions are sampled
+// that often for the per-opcode report.
+host_counters *host_counters_open(uint32_t sample_period) {
+    host_counters *h = calloc(1, sizeof(host_counters));
+    if (!h) {
+        perror("Error allocating host counters");
+        exit(EXIT_FAILURE);
+    }
+    h->leader = -1;
+    for (int e = 0; e < NUM_HOST_EVENTS; e++) {
+        h->fd[e] = -1;
+    }
+    h->sample_period = sample_period;
+    h->countdown = sample_period;
+#ifdef __linux__
+    for (int e = 0; e < NUM_HOST_EVENTS; e++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = events[e].type;
+        attr.config = events[e].config;
+        attr.disabled = h->leader < 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED
+                           | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        int fd = syscall(SYS_perf_event_open, &attr, 0, -1, h->leader, 0);
+        if (fd < 0) {
+            if (!h->error) {
+                h->error = strerror(errno);
+            }
+            continue;
+        }
+        if (h->leader < 0) {
+            h->leader = fd;
+        }
+        h->fd[e] = fd;
+        h->slot[e] = h->num_open++;
+    }
+
+    if (h->leader >= 0 && sample_period) {
+        //Take the cost of reading the counters twice out of each sample
+        group_read g;
+        uint64_t before[NUM_HOST_EVENTS], after[NUM_HOST_EVENTS];
+        for (int e = 0; e < NUM_HOST_EVENTS; e++) {
+            h->overhead[e] = UINT64_MAX;
+        }
+        ioctl(h->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        for (int i = 0; i < HOST_CALIBRATION_WINDOWS; i++) {
+            if (read_group(h, &g, before) && read_group(h, &g, after)) {
+                for (int e = 0; e < NUM_HOST_EVENTS; e++) {
+                    uint64_t n = after[e] - before[e];
+                    h->overhead[e] = n < h->overhead[e] ? n : h->overhead[e];
+                }
+            }
+        }
+        ioctl(h->leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        for (int e = 0; e < NUM_HOST_EVENTS; e++) {
+            h->overhead[e] = h->overhead[e] == UINT64_MAX ? 0 : h->overhead[e];
+        }
+    }
+#else
+    h->error = "perf_event_open is only available on Linux";
+#endif
+    return h;
+}
+
+void host_counters_close(host_counters *h) {
+    if (!h) {
+        return;
+    }
+#ifdef __linux__
+    for (int e = 0; e < NUM_HOST_EVENTS; e++) {
+        if (h->fd[e] >= 0) {
+            close(h->fd[e]);
+        }
+    }
+#endif
+    free(h);
+}
+
+// Zero the counts and start counting
+void host_counters_start(host_counters *h) {
+#ifdef __linux__
+    if (h->leader >= 0) {
+        ioctl(h->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(h->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+}
+
+// Stop counting and record the run's totals
+void host_counters_stop(host_counters *h) {
+#ifdef __linux__
+    group_read g;
+    if (h->leader < 0) {
+        return;
+    }
+    ioctl(h->leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    if (!read_group(h, &g, h->totals)) {
+        h->error = strerror(errno);
+        h->leader = -1;
+        return;
+    }
+    //The kernel multiplexes groups that don't fit on the PMU at once
+    if (g.time_running && g.time_running < g.time_enabled) {
+        h->scaled = true;
+        for (int e = 0; e < NUM_HOST_EVENTS; e++) {
+            h->totals[e] = (uint64_t) ((double) h->totals[e] * g.time_enabled / g.time_running);
+        }
+    }
+#endif
+}
+
+// Start the sample window around one guest instruction
+void host_sample_begin(host_counters *h) {
+    h->countdown = h->sample_period;
+#ifdef __linux__
+    group_read g;
+    h->sample_started = h->leader >= 0 && read_group(h, &g, h->sample_start);
+#endif
+}
+
+// End the sample window around one guest instruction, which ran op
+void host_sample_end(host_counters *h, handler_type op) {
+#ifdef __linux__
+    group_read g;
+    uint64_t counts[NUM_HOST_EVENTS];
+    if (!h->sample_started || !read_group(h, &g, counts)) {
+        return;
+    }
+    host_opcode *o = &h->opcodes[op];
+    o->samples++;
+    for (int e = 0; e < NUM_HOST_EVENTS; e++) {
+        uint64_t n = counts[e] - h->sample_start[e];
+        o->counts[e] += n > h->overhead[e] ? n - h->overhead[e] : 0;
+    }
+#else
+    (void) op;
+#endif
+}
+
+// Print the run's counts per guest instruction and, when sampling, each
+// opcode's average counts and estimated share of the host cycles (or
+// time, without a cycle counter), on out
+void host_counters_report(host_counters *h, uint64_t guest_steps, FILE *out) {
+    if (h->leader < 0) {
+        fprintf(out, "Host counters unavailable: %s\n", h->error ? h->error : "no events");
+        return;
+    }
+    fprintf(out, "Host counters (user space, %llu guest instructions%s):\n",
+            (unsigned long long) guest_steps, h->scaled ? ", scaled for multiplexing" : "");
+    for (int e = 0; e < NUM_HOST_EVENTS; e++) {
+        if (h->fd[e] < 0) {
+            fprintf(out, "%-16s %15s\n", event_names[e], "not counted");
+            continue;
+        }
+        fprintf(out, "%-16s %15llu %10.2f per guest instruction\n", event_names[e],
+                (unsigned long long) h->totals[e],
+                guest_steps ? (double) h->totals[e] / guest_steps : 0.0);
+    }
+    if (h->error && h->num_open < NUM_HOST_EVENTS) {
+        fprintf(out, "(some events could not be opened: %s)\n", h->error);
+    }
+    if (!h->sample_period) {
+        return;
+    }
+
+    host_event cost = h->fd[HOST_CYCLES] >= 0 ? HOST_CYCLES : HOST_TASK_CLOCK;
+    double total = 0;
+    for (int op = 0; op < NUM_BASE_HANDLERS; op++) {
+        total += h->opcodes[op].counts[cost];
+    }
+    fprintf(out, "Per opcode (1 in %u guest instructions sampled; averages per sample):\n",
+            h->sample_period);
+    fprintf(out, "%-8s %10s", "Opcode", "Samples");
+    for (int e = 0; e < NUM_HOST_EVENTS; e++) {
+        if (h->fd[e] >= 0) {
+            fprintf(out, " %15s", event_names[e]);
+        }
+    }
+    fprintf(out, " %7s of %s\n", "%", event_names[cost]);
+    for (int op = 0; op < NUM_BASE_HANDLERS; op++) {
+        host_opcode *o = &h->opcodes[op];
+        if (o->samples == 0) {
+            continue;
+        }
+        const char *name = vm_handler_name(op);
+        fprintf(out, "%-8.*s %10llu", (int) (strlen(name) - 2), name, (unsigned long long) o->samples);
+        for (int e = 0; e < NUM_HOST_EVENTS; e++) {
+            if (h->fd[e] >= 0) {
+                fprintf(out, " %15.2f", (double) o->counts[e] / o->samples);
+            }
+        }
+        fprintf(out, " %6.2f%%\n", total ? 100.0 * o->counts[cost] / total : 0.0);
+    }
+}
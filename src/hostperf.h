@@ -0,0 +1,61 @@
+#ifndef HOSTPERF_H
+#define HOSTPERF_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "vm.h"
+
+// Guest instructions between per-opcode samples (vm --host-opcodes);
+// prime, so the samples don't fall into step with a guest loop
+#define HOST_SAMPLE_PERIOD 997
+
+// Host events counted (vm --host-counters)
+typedef enum {
+    HOST_CYCLES,
+    HOST_INSTRUCTIONS,
+    HOST_BRANCH_MISSES,
+    HOST_L1D_MISSES,
+    HOST_TASK_CLOCK,            // nanoseconds; counted even where there are no hardware counters
+    NUM_HOST_EVENTS
+} host_event;
+
+// Counts over the samples of one opcode
+typedef struct {
+    uint64_t samples;
+    uint64_t counts[NUM_HOST_EVENTS];
+} host_opcode;
+
+// perf_event_open counters in one group, for the whole run and, when
+// sampling, for single guest instructions
+typedef struct host_counters {
+    int leader;                 // file descriptor of the group leader, or -1 if nothing could be opened
+    int fd[NUM_HOST_EVENTS];    // each event's file descriptor, or -1 if it isn't counted
+    int slot[NUM_HOST_EVENTS];  // each event's position in a group read
+    int num_open;
+    const char *error;          // why the first event that couldn't be opened wasn't
+    uint64_t totals[NUM_HOST_EVENTS]; // whole-run counts, scaled if the group was multiplexed
+    bool scaled;
+    uint32_t sample_period;     // guest instructions between samples, or 0 if not sampling
+    uint32_t countdown;         // guest instructions until the next sample
+    uint64_t sample_start[NUM_HOST_EVENTS];
+    bool sample_started;        // the current sample window's start was read
+    uint64_t overhead[NUM_HOST_EVENTS]; // what an empty sample window counts
+    host_opcode opcodes[NUM_BASE_HANDLERS];
+} host_counters;
+
+// Is the instruction about to run one to sample?
+static inline bool host_sample_due(host_counters *h) {
+    return h && --h->countdown == 0;
+}
+
+// Function declarations
+host_counters *host_counters_open(uint32_t sample_period);
+void host_counters_close(host_counters *h);
+void host_counters_start(host_counters *h);
+void host_counters_stop(host_counters *h);
+void host_sample_begin(host_counters *h);
+void host_sample_end(host_counters *h, handler_type op);
+void host_counters_report(host_counters *h, uint64_t guest_steps, FILE *out);
+
+#endif // HOSTPERF_H
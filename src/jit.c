@@ -0,0 +1,653 @@
+#define _GNU_SOURCE
+#include "jit.h"
+
+#ifdef VM_JIT
+
+#include <ucontext.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/mman.h>
+
+// Most code a single block can need: 64 instructions of at most ~100 bytes,
+// their side exits, the prologue and the epilogue.
+#define MAX_BLOCK_CODE (16 * 1024)
+
+// Most side exits and jumps one block can have
+#define MAX_FIXUPS 256
+
+// x86-64 register numbers
+enum {RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15};
+
+// Host registers holding the guest GPRs while a block runs
+// ($gp, $sp, $fp, $r3, $r4, $r5, $r6, $ra). RDI holds the VM, RSI the
+// guest memory, R10 the step budget, R11 the steps retired, and RAX, RCX
+// and RDX are scratch.
+static const int host_reg[NUM_REGISTERS] = {RBX, RBP, R12, R13, R14, R15, R8, R9};
+
+// Callee-saved registers the prologue pushes
+static const int saved_regs[] = {RBX, RBP, R12, R13, R14, R15};
+#define NUM_SAVED (int) (sizeof(saved_regs) / sizeof(saved_regs[0]))
+
+// x86 condition codes for Jcc
+enum {CC_B = 0x2, CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5,
+      CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF};
+
+// A jump whose 32-bit displacement is filled in once the code after it is laid out
+typedef struct {
+    size_t at;                  // offset of the displacement
+    int32_t side_exit_pc;       // for side exits: PC of the instruction to leave at
+    int steps;                  // for side exits: instructions retired before it
+    bool to_epilogue;           // plain jump to the epilogue
+} fixup;
+
+// Where a compiled block's code is, so a fault inside it can be traced
+// back to the guest instruction it was running (see jit_fault)
+typedef struct {
+    const uint8_t *code;        // entry point
+    const uint8_t *end;         // end of its code, side exits and epilogue
+    int32_t start;              // text address of its first instruction
+    unsigned used;              // guest registers held in host registers
+    size_t first;               // its instructions' entries in offsets
+    int length;                 // instructions compiled
+} block_map;
+
+struct jit_state {
+    uint8_t *base;              // executable buffer
+    size_t used;                // bytes handed out so far
+    uint8_t *p;                 // emission point of the block being compiled
+    fixup fixups[MAX_FIXUPS];
+    int num_fixups;
+    bool overflow;              // too many fixups; give up on this block
+    block_map *maps;            // compiled blocks, in order of their code
+    int num_maps;
+    int maps_capacity;
+    uint32_t *offsets;          // each compiled instruction's code offset in its block
+    size_t num_offsets;
+    size_t offsets_capacity;
+};
+
+// Allocate the code buffer
+jit_state *jit_create(void) {
+    jit_state *j = calloc(1, sizeof(jit_state));
+    if (!j) {
+        perror("Error allocating JIT state");
+        exit(EXIT_FAILURE);
+    }
+    j->base = mmap(NULL, JIT_CODE_BYTES, PROT_READ | PROT_EXEC,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (j->base == MAP_FAILED) {
+        perror("Error mapping JIT code buffer");
+        exit(EXIT_FAILURE);
+    }
+    return j;
+}
+
+void jit_destroy(jit_state *j) {
+    if (!j) {
+        return;
+    }
+    munmap(j->base, JIT_CODE_BYTES);
+    free(j->maps);
+    free(j->offsets);
+    free(j);
+}
+
+// Instruction encoding
+
+static void emit8(jit_state *j, uint8_t b) {
+    *j->p++ = b;
+}
+
+static void emit32(jit_state *j, uint32_t v) {
+    memcpy(j->p, &v, 4);
+    j->p += 4;
+}
+
+static void emit64(jit_state *j, uint64_t v) {
+    memcpy(j->p, &v, 8);
+    j->p += 8;
+}
+
+// REX prefix; emitted only when needed (w, or any extended register)
+static void rex(jit_state *j, int w, int reg, int index, int base) {
+    uint8_t r = 0x40 | (w << 3) | (((reg >> 3) & 1) << 2)
+        | (((index >> 3) & 1) << 1) | ((base >> 3) & 1);
+    if (r != 0x40) {
+        emit8(j, r);
+    }
+}
+
+// Emit op with a register/register ModRM byte (reg field, rm register)
+static void op_rr(jit_state *j, int w, const char *op, int oplen, int reg, int rm) {
+    rex(j, w, reg, 0, rm);
+    for (int i = 0; i < oplen; i++) {
+        emit8(j, (uint8_t) op[i]);
+    }
+    emit8(j, 0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+// Emit op with a memory operand [base + (index << scale) + disp] (index < 0 for none)
+static void op_rm_scaled(jit_state *j, int w, const char *op, int oplen, int reg,
+                         int base, int index, int scale, int32_t disp) {
+    rex(j, w, reg, index < 0 ? 0 : index, base);
+    for (int i = 0; i < oplen; i++) {
+        emit8(j, (uint8_t) op[i]);
+    }
+    if (index < 0 && (base & 7) != RSP) {
+        emit8(j, 0x80 | ((reg & 7) << 3) | (base & 7));
+    } else {
+        emit8(j, 0x80 | ((reg & 7) << 3) | RSP);
+        emit8(j, (index < 0 ? 0 : scale << 6) | (((index < 0 ? RSP : index) & 7) << 3) | (base & 7));
+    }
+    emit32(j, (uint32_t) disp);
+}
+
+// Emit op with a memory operand [base + index*4 + disp] (index < 0 for none)
+static void op_rm(jit_state *j, int w, const char *op, int oplen, int reg,
+                  int base, int index, int32_t disp) {
+    op_rm_scaled(j, w, op, oplen, reg, base, index, 2, disp);
+}
+
+// mov r32, imm32
+static void mov_ri(jit_state *j, int r, uint32_t imm) {
+    rex(j, 0, 0, 0, r);
+    emit8(j, 0xB8 + (r & 7));
+    emit32(j, imm);
+}
+
+// mov r64, imm64
+static void mov_ri64(jit_state *j, int r, uint64_t imm) {
+    rex(j, 1, 0, 0, r);
+    emit8(j, 0xB8 + (r & 7));
+    emit64(j, imm);
+}
+
+// ALU group 1 (81 /n) on a register: n is 0 add, 1 or, 4 and, 5 sub, 6 xor, 7 cmp
+static void alu_ri(jit_state *j, int w, int n, int r, uint32_t imm) {
+    op_rr(j, w, "\x81", 1, n, r);
+    emit32(j, imm);
+}
+
+// ALU group 1 (81 /n) on guest memory word [RSI + index*4]
+static void alu_mi(jit_state *j, int n, int index, uint32_t imm) {
+    op_rm(j, 0, "\x81", 1, n, RSI, index, 0);
+    emit32(j, imm);
+}
+
+static void push(jit_state *j, int r) {
+    rex(j, 0, 0, 0, r);
+    emit8(j, 0x50 + (r & 7));
+}
+
+static void pop(jit_state *j, int r) {
+    rex(j, 0, 0, 0, r);
+    emit8(j, 0x58 + (r & 7));
+}
+
+// Emit a rel32 jump (cc < 0 for unconditional) and return the offset of its displacement
+static size_t jump(jit_state *j, int cc) {
+    if (cc < 0) {
+        emit8(j, 0xE9);
+    } else {
+        emit8(j, 0x0F);
+        emit8(j, 0x80 + cc);
+    }
+    size_t at = j->p - j->base;
+    emit32(j, 0);
+    return at;
+}
+
+// Point the displacement at offset at to the current emission point
+static void patch_here(jit_state *j, size_t at) {
+    int32_t rel = (int32_t) ((j->p - j->base) - (at + 4));
+    memcpy(j->base + at, &rel, 4);
+}
+
+static void add_fixup(jit_state *j, size_t at, bool to_epilogue, int32_t pc, int steps) {
+    if (j->num_fixups == MAX_FIXUPS) {
+        j->overflow = true;
+        return;
+    }
+    fixup *f = &j->fixups[j->num_fixups++];
+    f->at = at;
+    f->to_epilogue = to_epilogue;
+    f->side_exit_pc = pc;
+    f->steps = steps;
+}
+
+// Guest operations
+
+// dst (64-bit) = sign-extended guest register r + off, a word index into guest memory
+static void guest_addr(jit_state *j, int dst, int r, int32_t off) {
+    op_rm(j, 0, "\x8D", 1, dst, host_reg[r], -1, off);     // lea dst32, [reg + off]
+    op_rr(j, 1, "\x63", 1, dst, dst);                       // movsxd dst, dst32
+}
+
+// dst (64-bit) = sign-extended $sp, the index of the word on top of the stack
+static void stack_top_addr(jit_state *j, int dst) {
+    op_rr(j, 1, "\x63", 1, dst, host_reg[SP]);
+}
+
+
+// Leave through a side exit at the instruction at pc unless the word index
+// in register index is outside the text section (stores there are left
+// to the interpreter, which keeps the decoded forms of the text current),
+// then mark the word's page dirty. Clobbers RDX.
+static void check_store(jit_state *j, int index, int32_t text_words, int32_t pc, int steps) {
+    alu_ri(j, 0, 7, index, (uint32_t) text_words);          // cmp index32, text_words
+    add_fixup(j, jump(j, CC_B), false, pc, steps);
+    // VM_MARK_DIRTY, using RDX
+    op_rr(j, 0, "\x89", 1, index, RDX);                     // mov edx, index32
+    op_rr(j, 0, "\xC1", 1, 5, RDX);                         // shr edx, VM_PAGE_SHIFT
+    emit8(j, VM_PAGE_SHIFT);
+    alu_ri(j, 0, 4, RDX, VM_NUM_PAGES - 1);                 // and edx, VM_NUM_PAGES - 1
+    op_rm(j, 1, "\x03", 1, RDX, RDI, -1, (int32_t) offsetof(VM, dirty_pages)); // add rdx, [dirty_pages]
+    op_rm(j, 0, "\xC6", 1, 0, RDX, -1, 0);
+    emit8(j, 1);                                            // mov byte [rdx], 1
+    op_rr(j, 0, "\x89", 1, index, RDX);                     // mov edx, index32
+    op_rr(j, 0, "\xC1", 1, 5, RDX);                         // shr edx, VM_DIR_SHIFT
+    emit8(j, VM_DIR_SHIFT);
+    alu_ri(j, 0, 4, RDX, VM_NUM_DIRS - 1);                  // and edx, VM_NUM_DIRS - 1
+    op_rm_scaled(j, 0, "\xC6", 1, 0, RDI, RDX, 0, (int32_t) offsetof(VM, dirty_dirs));
+    emit8(j, 1);                                            // mov byte [dirty_dirs + rdx], 1
+}
+
+// Load the word at [RSI + index*4] into r32
+static void load(jit_state *j, int r, int index) {
+    op_rm(j, 0, "\x8B", 1, r, RSI, index, 0);
+}
+
+// Store r32 into [RSI + index*4]
+static void store(jit_state *j, int r, int index) {
+    op_rm(j, 0, "\x89", 1, r, RSI, index, 0);
+}
+
+// Finish the block: R11 += steps, EAX = the next PC (already set), jump to the epilogue
+static void exit_block(jit_state *j, int steps) {
+    if (steps) {
+        alu_ri(j, 1, 0, R11, (uint32_t) steps);            // add r11, steps
+    }
+    add_fixup(j, jump(j, -1), true, 0, 0);
+}
+
+// Leave with EAX = target, or loop back to the block's body if target is its start
+// and another full pass fits in the budget
+static void branch_to(jit_state *j, int32_t target, int32_t start, int length, uint8_t *body) {
+    if (target == start) {
+        alu_ri(j, 1, 0, R11, (uint32_t) length);           // add r11, length
+        op_rr(j, 1, "\x89", 1, R10, RAX);                   // mov rax, r10
+        op_rr(j, 1, "\x29", 1, R11, RAX);                   // sub rax, r11
+        alu_ri(j, 1, 7, RAX, (uint32_t) length);           // cmp rax, length
+        size_t out = jump(j, CC_B);
+        size_t back = jump(j, -1);
+        int32_t rel = (int32_t) (body - (j->base + back + 4));
+        memcpy(j->base + back, &rel, 4);
+        patch_here(j, out);
+        mov_ri(j, RAX, (uint32_t) target);
+        exit_block(j, 0);
+    } else {
+        mov_ri(j, RAX, (uint32_t) target);
+        exit_block(j, length);
+    }
+}
+
+// Can the JIT compile the instruction run by handler h?
+static bool supported(uint8_t h) {
+    switch (h) {
+        case DIV_H:
+        case EXIT_H: case PSTR_H: case PINT_H: case PCH_H: case RCH_H:
+        case STRA_H: case NOTR_H: case ILLEGAL_H:
+            return false;
+        default:
+            return h < NUM_BASE_HANDLERS;
+    }
+}
+
+// Record which guest registers d reads or writes in *used, and which it writes in *written
+static void note_registers(const decoded_instr_t *d, unsigned *used, unsigned *written) {
+    switch (d->handler) {
+        case NOP_H: case JMPA_H:
+            break;
+        case ARI_H: case SRI_H:
+            *used |= 1u << d->rt;
+            *written |= 1u << d->rt;
+            break;
+        case LWR_H:
+            *used |= 1u << d->rt | 1u << d->rs;
+            *written |= 1u << d->rt;
+            break;
+        case CALL_H: case RTN_H:
+            *used |= 1u << RA;
+            *written |= 1u << RA;
+            break;
+        case CSI_H:
+            *used |= 1u << d->rt | 1u << RA;
+            *written |= 1u << RA;
+            break;
+        default:
+            *used |= 1u << d->rt | 1u << d->rs | 1u << SP;
+            break;
+    }
+}
+
+// Compile one instruction at address addr, the i-th of the block.
+// Control transfers are only ever the last instruction.
+// Returns true if the code emitted always leaves the block.
+static bool compile_instr(jit_state *j, const decoded_instr_t *d, int32_t addr, int i,
+                          int32_t start, int length, int32_t text_words, uint8_t *body) {
+    int cc = -1;
+    switch (d->handler) {
+        case NOP_H:
+            break;
+        case ADD_H: case SUB_H: case AND_H: case BOR_H: case NOR_H: case XOR_H: {
+            static const char ops[] = {[ADD_H] = 0x03, [SUB_H] = 0x2B, [AND_H] = 0x23,
+                                       [BOR_H] = 0x0B, [NOR_H] = 0x0B, [XOR_H] = 0x33};
+            guest_addr(j, RAX, d->rt, d->ot);
+            guest_addr(j, RCX, d->rs, d->os);
+            check_store(j, RAX, text_words, addr, i);
+            stack_top_addr(j, RDX);
+            load(j, RDX, RDX);
+            op_rm(j, 0, &ops[d->handler], 1, RDX, RSI, RCX, 0);   // op edx, [s]
+            if (d->handler == NOR_H) {
+                op_rr(j, 0, "\xF7", 1, 2, RDX);                    // not edx
+            }
+            store(j, RDX, RAX);
+            break;
+        }
+        case CPW_H: case NEG_H:
+            guest_addr(j, RAX, d->rt, d->ot);
+            guest_addr(j, RCX, d->rs, d->os);
+            check_store(j, RAX, text_words, addr, i);
+            load(j, RDX, RCX);
+            if (d->handler == NEG_H) {
+                op_rr(j, 0, "\xF7", 1, 3, RDX);                    // neg edx
+            }
+            store(j, RDX, RAX);
+            break;
+        case LWR_H:
+            guest_addr(j, RCX, d->rs, d->os);
+            load(j, host_reg[d->rt], RCX);
+            break;
+        case SWR_H:
+            guest_addr(j, RAX, d->rt, d->ot);
+            check_store(j, RAX, text_words, addr, i);
+            store(j, host_reg[d->rs], RAX);
+            break;
+        case SCA_H:
+            guest_addr(j, RAX, d->rt, d->ot);
+            check_store(j, RAX, text_words, addr, i);
+            op_rm(j, 0, "\x8D", 1, RDX, host_reg[d->rs], -1, d->os);  // lea edx, [rs + os]
+            store(j, RDX, RAX);
+            break;
+        case LWI_H:
+            guest_addr(j, RAX, d->rt, d->ot);
+            check_store(j, RAX, text_words, addr, i);
+            guest_addr(j, RCX, d->rs, d->os);
+            op_rm(j, 1, "\x63", 1, RCX, RSI, RCX, 0);             // movsxd rcx, [s]
+            load(j, RDX, RCX);
+            store(j, RDX, RAX);
+            break;
+        case LIT_H:
+            guest_addr(j, RAX, d->rt, d->ot);
+            check_store(j, RAX, text_words, addr, i);
+            op_rm(j, 0, "\xC7", 1, 0, RSI, RAX, 0);               // mov dword [t], imm
+            emit32(j, (uint32_t) d->imm);
+            break;
+        case ARI_H:
+            alu_ri(j, 0, 0, host_reg[d->rt], (uint32_t) d->imm);
+            break;
+        case SRI_H:
+            alu_ri(j, 0, 5, host_reg[d->rt], (uint32_t) d->imm);
+            break;
+        case MUL_H:
+            stack_top_addr(j, RDX);
+            op_rm(j, 1, "\x63", 1, RDX, RSI, RDX, 0);             // movsxd rdx, [top]
+            guest_addr(j, RAX, d->rt, d->ot);
+            op_rm(j, 1, "\x63", 1, RAX, RSI, RAX, 0);             // movsxd rax, [t]
+            op_rr(j, 1, "\x0F\xAF", 2, RAX, RDX);                 // imul rax, rdx
+            op_rm(j, 0, "\x89", 1, RAX, RDI, -1, (int32_t) offsetof(VM, LO));
+            op_rr(j, 1, "\xC1", 1, 5, RAX);                       // shr rax, 32
+            emit8(j, 32);
+            op_rm(j, 0, "\x89", 1, RAX, RDI, -1, (int32_t) offsetof(VM, HI));
+            break;
+        case CFHI_H: case CFLO_H:
+            guest_addr(j, RAX, d->rt, d->ot);
+            check_store(j, RAX, text_words, addr, i);
+            op_rm(j, 0, "\x8B", 1, RDX, RDI, -1,
+                  (int32_t) (d->handler == CFHI_H ? offsetof(VM, HI) : offsetof(VM, LO)));
+            store(j, RDX, RAX);
+            break;
+        case SLL_H: case SRL_H:
+            guest_addr(j, RAX, d->rt, d->ot);
+            check_store(j, RAX, text_words, addr, i);
+            stack_top_addr(j, RDX);
+            load(j, RDX, RDX);
+            op_rr(j, 0, "\xC1", 1, d->handler == SLL_H ? 4 : 5, RDX);  // shl/shr edx, imm8
+            emit8(j, (uint8_t) d->imm);
+            store(j, RDX, RAX);
+            break;
+        case ADDI_H: case ANDI_H: case BORI_H: case XORI_H: {
+            static const int group[] = {[ADDI_H] = 0, [ANDI_H] = 4, [BORI_H] = 1, [XORI_H] = 6};
+            guest_addr(j, RAX, d->rt, d->ot);
+            check_store(j, RAX, text_words, addr, i);
+            alu_mi(j, group[d->handler], RAX, (uint32_t) d->imm);
+            break;
+        }
+        case NORI_H:
+            guest_addr(j, RAX, d->rt, d->ot);
+            check_store(j, RAX, text_words, addr, i);
+            load(j, RDX, RAX);
+            alu_ri(j, 0, 1, RDX, (uint32_t) d->imm);               // or edx, imm
+            op_rr(j, 0, "\xF7", 1, 2, RDX);                        // not edx
+            store(j, RDX, RAX);
+            break;
+        case BEQ_H: case BNE_H:
+            stack_top_addr(j, RDX);
+            load(j, RDX, RDX);
+            guest_addr(j, RAX, d->rt, d->ot);
+            op_rm(j, 0, "\x3B", 1, RDX, RSI, RAX, 0);             // cmp edx, [t]
+            cc = d->handler == BEQ_H ? CC_E : CC_NE;
+            break;
+        case BGEZ_H: case BGTZ_H: case BLEZ_H: case BLTZ_H:
+            guest_addr(j, RAX, d->rt, d->ot);
+            alu_mi(j, 7, RAX, 0);                                  // cmp dword [t], 0
+            cc = d->handler == BGEZ_H ? CC_GE : d->handler == BGTZ_H ? CC_G
+                : d->handler == BLEZ_H ? CC_LE : CC_L;
+            break;
+        case JMPA_H: case JREL_H:
+            branch_to(j, d->target, start, length, body);
+            return true;
+        case CALL_H:
+            mov_ri(j, host_reg[RA], (uint32_t) (addr + 1));
+            branch_to(j, d->target, start, length, body);
+            return true;
+        case RTN_H:
+            op_rr(j, 0, "\x89", 1, host_reg[RA], RAX);            // mov eax, ra
+            exit_block(j, length);
+            return true;
+        case JMP_H: case CSI_H:
+            guest_addr(j, RAX, d->rt, d->ot);
+            if (d->handler == CSI_H) {
+                mov_ri(j, host_reg[RA], (uint32_t) (addr + 1));
+            }
+            load(j, RAX, RAX);
+            exit_block(j, length);
+            return true;
+    }
+    if (cc < 0) {
+        return false;
+    }
+    size_t taken = jump(j, cc);
+    mov_ri(j, RAX, (uint32_t) (addr + 1));
+    exit_block(j, length);
+    patch_here(j, taken);
+    branch_to(j, d->target, start, length, body);
+    return true;
+}
+
+// Compile the block of length decoded instructions starting at text address
+// start into native code. Compiles the longest prefix the JIT supports; the
+// instruction after it is left to the interpreter through a side exit.
+// Returns NULL if no prefix can be compiled or the code buffer is full.
+jit_fn jit_compile(jit_state *j, const decoded_instr_t *code, int length,
+                   int32_t start, int32_t text_words) {
+    int n = 0;
+    while (n < length && supported(code[n].handler)) {
+        n++;
+    }
+    if (n == 0 || j->used + MAX_BLOCK_CODE > JIT_CODE_BYTES) {
+        return NULL;
+    }
+    if (mprotect(j->base, JIT_CODE_BYTES, PROT_READ | PROT_WRITE) != 0) {
+        perror("Error unprotecting JIT code buffer");
+        exit(EXIT_FAILURE);
+    }
+
+    uint8_t *entry = j->base + j->used;
+    j->p = entry;
+    j->num_fixups = 0;
+    j->overflow = false;
+
+    unsigned used = 0, written = 0;
+    for (int i = 0; i < n; i++) {
+        note_registers(&code[i], &used, &written);
+    }
+
+    // prologue: save callee-saved registers and the steps pointer, load guest registers
+    for (int i = 0; i < NUM_SAVED; i++) {
+        push(j, saved_regs[i]);
+    }
+    push(j, RCX);
+    op_rr(j, 1, "\x89", 1, RDX, R10);                             // mov r10, rdx
+    op_rr(j, 0, "\x31", 1, R11, R11);                             // xor r11d, r11d
+    for (int r = 0; r < NUM_REGISTERS; r++) {
+        if (used & (1u << r)) {
+            op_rm(j, 0, "\x8B", 1, host_reg[r], RDI, -1,
+                  (int32_t) (offsetof(VM, registers) + r * sizeof(int32_t)));
+        }
+    }
+
+    if (j->num_offsets + n > j->offsets_capacity) {
+        j->offsets_capacity = (j->num_offsets + n) * 2;
+        j->offsets = realloc(j->offsets, j->offsets_capacity * sizeof(uint32_t));
+    }
+    if (j->num_maps == j->maps_capacity) {
+        j->maps_capacity = j->maps_capacity ? j->maps_capacity * 2 : 64;
+        j->maps = realloc(j->maps, j->maps_capacity * sizeof(block_map));
+    }
+    if (!j->offsets || !j->maps) {
+        perror("Error allocating JIT code map");
+        exit(EXIT_FAILURE);
+    }
+
+    uint8_t *body = j->p;
+    bool left = false;
+    for (int i = 0; i < n; i++) {
+        j->offsets[j->num_offsets + i] = (uint32_t) (j->p - entry);
+        left = compile_instr(j, &code[i], start + i, i, start, n, text_words, body);
+    }
+    if (!left) {
+        // fell off the end of the compiled prefix
+        if (n < length) {
+            alu_ri(j, 1, 0, R11, (uint32_t) n);
+            mov_ri64(j, RAX, JIT_SIDE_EXIT | (uint32_t) (start + n));
+            add_fixup(j, jump(j, -1), true, 0, 0);
+        } else {
+            mov_ri(j, RAX, (uint32_t) (start + n));
+            exit_block(j, n);
+        }
+    }
+
+    // side exits: R11 += instructions retired, RAX = PC | JIT_SIDE_EXIT
+    int num = j->num_fixups;
+    for (int f = 0; f < num; f++) {
+        if (j->fixups[f].to_epilogue) {
+            continue;
+        }
+        patch_here(j, j->fixups[f].at);
+        if (j->fixups[f].steps) {
+            alu_ri(j, 1, 0, R11, (uint32_t) j->fixups[f].steps);
+        }
+        mov_ri64(j, RAX, JIT_SIDE_EXIT | (uint32_t) j->fixups[f].side_exit_pc);
+        add_fixup(j, jump(j, -1), true, 0, 0);
+    }
+
+    // epilogue: store written guest registers, report steps, restore
+    for (int f = 0; f < j->num_fixups; f++) {
+        if (j->fixups[f].to_epilogue) {
+            patch_here(j, j->fixups[f].at);
+        }
+    }
+    for (int r = 0; r < NUM_REGISTERS; r++) {
+        if (written & (1u << r)) {
+            op_rm(j, 0, "\x89", 1, host_reg[r], RDI, -1,
+                  (int32_t) (offsetof(VM, registers) + r * sizeof(int32_t)));
+        }
+    }
+    pop(j, RCX);
+    op_rm(j, 1, "\x89", 1, R11, RCX, -1, 0);                      // mov [rcx], r11
+    for (int i = NUM_SAVED - 1; i >= 0; i--) {
+        pop(j, saved_regs[i]);
+    }
+    emit8(j, 0xC3);                                               // ret
+
+    if (mprotect(j->base, JIT_CODE_BYTES, PROT_READ | PROT_EXEC) != 0) {
+        perror("Error protecting JIT code buffer");
+        exit(EXIT_FAILURE);
+    }
+    if (j->overflow) {
+        return NULL;
+    }
+    j->maps[j->num_maps++] = (block_map) {entry, j->p, start, used, j->num_offsets, n};
+    j->num_offsets += n;
+    j->used = (j->p - j->base + 15) & ~(size_t) 15;
+    return (jit_fn) entry;
+}
+
+// Called from a signal handler for a fault with machine context context
+// (a ucontext_t). If it happened inside a compiled block, copy the guest
+// registers the block holds in host registers back into vm and return
+// true, with the address of the guest instruction that faulted in *pc
+// and the number of instructions this call of the block had started,
+// counting that one, in *started.
+bool jit_fault(const jit_state *j, const void *context, VM *vm, int32_t *pc, uint64_t *started) {
+    static const int greg[16] = {
+        REG_RAX, REG_RCX, REG_RDX, REG_RBX, REG_RSP, REG_RBP, REG_RSI, REG_RDI,
+        REG_R8, REG_R9, REG_R10, REG_R11, REG_R12, REG_R13, REG_R14, REG_R15
+    };
+    if (!j) {
+        return false;
+    }
+    const greg_t *gregs = ((const ucontext_t *) context)->uc_mcontext.gregs;
+    const uint8_t *rip = (const uint8_t *) gregs[REG_RIP];
+    int lo = 0, hi = j->num_maps;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (j->maps[mid].end <= rip) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == j->num_maps || rip < j->maps[lo].code) {
+        return false;
+    }
+    const block_map *m = &j->maps[lo];
+    uint32_t offset = (uint32_t) (rip - m->code);
+    int i = 0;
+    while (i + 1 < m->length && j->offsets[m->first + i + 1] <= offset) {
+        i++;
+    }
+    for (int r = 0; r < NUM_REGISTERS; r++) {
+        if (m->used & (1u << r)) {
+            vm->registers[r] = (int32_t) gregs[greg[host_reg[r]]];
+        }
+    }
+    *pc = m->start + i;
+    *started = (uint64_t) gregs[REG_R11] + i + 1;
+    return true;
+}
+
+#endif // VM_JIT
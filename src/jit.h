@@ -0,0 +1,43 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "vm.h"
+
+// The JIT only exists on Linux/x86-64; elsewhere VM_JIT is ignored.
+#if defined(VM_JIT) && !(defined(__x86_64__) && defined(__linux__))
+#undef VM_JIT
+#endif
+
+// Block entries before a block is compiled (vm -j); vm -J compiles on first entry
+#define JIT_THRESHOLD 20
+
+#ifdef VM_JIT
+
+// Size of the executable code buffer
+#define JIT_CODE_BYTES (4 * 1024 * 1024)
+
+// Set in a compiled block's result when it stopped before an instruction
+// it could not run (a syscall, DIV, or a store into the text section).
+// That instruction, at the returned PC, must be run by the interpreter.
+#define JIT_SIDE_EXIT (1ULL << 32)
+
+// Native code for one basic block.
+// Runs the block (looping back to its start while it branches there and
+// another pass fits in budget), stores the number of instructions it
+// retired in *steps, and returns the next PC, or'ed with JIT_SIDE_EXIT if it stopped early.
+typedef uint64_t (*jit_fn)(VM *vm, int32_t *memory, uint64_t budget, uint64_t *steps);
+
+typedef struct jit_state jit_state;
+
+// Function declarations
+jit_state *jit_create(void);
+void jit_destroy(jit_state *j);
+jit_fn jit_compile(jit_state *j, const decoded_instr_t *code, int length,
+                   int32_t start, int32_t text_words);
+bool jit_fault(const jit_state *j, const void *context, VM *vm, int32_t *pc, uint64_t *started);
+
+#endif // VM_JIT
+
+#endif // JIT_H
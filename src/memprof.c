@@ -0,0 +1,377 @@
+#include "memprof.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Time slots the reuse-distance tree starts with (it grows as needed)
+#define MEMPROF_SLOTS (1u << 16)
+
+// Rows in each region's heatmap, and width of its bars
+#define HEATMAP_ROWS 16
+#define HEATMAP_WIDTH 40
+
+static const char *kind_names[NUM_MEM_KINDS] = {
+    "$gp-relative", "$sp/$fp-relative", "other register", "indirect (LWI)"
+};
+
+// Allocate the reuse-distance tree and slot map for m->capacity slots
+static void alloc_slots(mem_profile *m) {
+    free(m->tree);
+    free(m->slot_word);
+    m->tree = calloc(m->capacity + 1, sizeof(uint32_t));
+    m->slot_word = malloc((m->capacity + 1) * sizeof(int32_t));
+    if (!m->tree || !m->slot_word) {
+        perror("Error allocating memory profile");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Allocate an empty profile
+mem_profile *memprof_create(void) {
+    mem_profile *m = calloc(1, sizeof(mem_profile));
+    if (m) {
+        m->pages = calloc(VM_NUM_PAGES, sizeof(mem_page *));
+    }
+    if (!m || !m->pages) {
+        perror("Error allocating memory profile");
+        exit(EXIT_FAILURE);
+    }
+    m->capacity = MEMPROF_SLOTS;
+    alloc_slots(m);
+    return m;
+}
+
+void memprof_destroy(mem_profile *m) {
+    if (!m) {
+        return;
+    }
+    for (uint32_t i = 0; i < VM_NUM_PAGES; i++) {
+        free(m->pages[i]);
+    }
+    free(m->pages);
+    free(m->tree);
+    free(m->slot_word);
+    free(m);
+}
+
+static void tree_add(mem_profile *m, uint32_t slot, int32_t delta) {
+    for (; slot <= m->capacity; slot += slot & -slot) {
+        m->tree[slot] += delta;
+    }
+}
+
+// Number of words whose last access is at or before slot
+static uint32_t tree_sum(mem_profile *m, uint32_t slot) {
+    uint32_t sum = 0;
+    for (; slot > 0; slot -= slot & -slot) {
+        sum += m->tree[slot];
+    }
+    return sum;
+}
+
+static mem_page *page_of(mem_profile *m, int32_t addr) {
+    mem_page **page = &m->pages[addr >> VM_PAGE_SHIFT];
+    if (!*page) {
+        *page = calloc(1, sizeof(mem_page));
+        if (!*page) {
+            perror("Error allocating memory profile");
+            exit(EXIT_FAILURE);
+        }
+    }
+    return *page;
+}
+
+// Renumber the live slots (each word's last access) from 1, in order,
+// doubling the number of slots if more than half of them are live
+static void compact_slots(mem_profile *m) {
+    int32_t *words = malloc((m->live + 1) * sizeof(int32_t));
+    if (!words) {
+        perror("Error allocating memory profile");
+        exit(EXIT_FAILURE);
+    }
+    uint32_t n = 0;
+    for (uint32_t slot = 1; slot <= m->now; slot++) {
+        if (m->slot_word[slot] >= 0) {
+            words[n++] = m->slot_word[slot];
+        }
+    }
+    if (2 * m->live > m->capacity) {
+        m->capacity *= 2;
+    }
+    alloc_slots(m);
+    for (uint32_t slot = 1; slot <= n; slot++) {
+        int32_t addr = words[slot - 1];
+        m->slot_word[slot] = addr;
+        page_of(m, addr)->last[addr & (VM_PAGE_WORDS - 1)] = slot;
+        tree_add(m, slot, 1);
+    }
+    m->now = n;
+    free(words);
+}
+
+// Count an access of kind to the word at addr, in reads or writes
+static void access_word(mem_profile *m, VM *vm, int32_t addr, mem_kind kind, bool write) {
+    if ((uint32_t) addr >= vm->memory_words) {
+        return;
+    }
+    if (m->now == m->capacity) {
+        compact_slots(m);
+    }
+    mem_page *page = page_of(m, addr);
+    int32_t i = addr & (VM_PAGE_WORDS - 1);
+    if (write) {
+        page->writes[i]++;
+        m->writes[kind]++;
+    } else {
+        page->reads[i]++;
+        m->reads[kind]++;
+    }
+
+    uint32_t slot = ++m->now;
+    uint32_t last = page->last[i];
+    int bucket = 0;
+    if (last) {
+        //Distinct words accessed since this one last was
+        uint32_t distance = tree_sum(m, slot - 1) - tree_sum(m, last);
+        for (bucket = 1; distance > 0; distance >>= 1) {
+            bucket++;
+        }
+        tree_add(m, last, -1);
+        m->slot_word[last] = -1;
+    } else {
+        m->live++;
+    }
+    m->reuse[kind][bucket]++;
+    tree_add(m, slot, 1);
+    m->slot_word[slot] = addr;
+    page->last[i] = slot;
+}
+
+// Kind of an access addressed by register r plus an offset
+static mem_kind kind_of(int r) {
+    if (r == GP) {
+        return MEM_GP;
+    }
+    return r == SP || r == FP ? MEM_STACK : MEM_OTHER;
+}
+
+#define TARGET(d) (vm->registers[(d)->rt] + (d)->ot)
+#define SOURCE(d) (vm->registers[(d)->rs] + (d)->os)
+#define READ(a, k) access_word(m, vm, a, k, false)
+#define WRITE(a, k) access_word(m, vm, a, k, true)
+
+// Count the memory accesses the instruction d is about to make, from the
+// VM's state before it runs: its reads, then its writes
+void memprof_step(mem_profile *m, VM *vm, const decoded_instr_t *d) {
+    int32_t top = vm->registers[SP];
+    switch (d->handler) {
+    case ADD_H: case SUB_H: case AND_H: case BOR_H: case NOR_H: case XOR_H:
+        READ(top, MEM_STACK);
+        READ(SOURCE(d), kind_of(d->rs));
+        WRITE(TARGET(d), kind_of(d->rt));
+        break;
+    case CPW_H: case NEG_H:
+        READ(SOURCE(d), kind_of(d->rs));
+        WRITE(TARGET(d), kind_of(d->rt));
+        break;
+    case LWR_H:
+        READ(SOURCE(d), kind_of(d->rs));
+        break;
+    case SWR_H: case SCA_H: case LIT_H: case CFHI_H: case CFLO_H: case RCH_H:
+        WRITE(TARGET(d), kind_of(d->rt));
+        break;
+    case LWI_H: {
+        int32_t s = SOURCE(d);
+        READ(s, kind_of(d->rs));
+        if ((uint32_t) s < vm->memory_words) {
+            READ(vm->memory->words[s], MEM_INDIRECT);
+        }
+        WRITE(TARGET(d), kind_of(d->rt));
+        break;
+    }
+    case MUL_H: case DIV_H: case BEQ_H: case BNE_H:
+        READ(top, MEM_STACK);
+        READ(TARGET(d), kind_of(d->rt));
+        break;
+    case SLL_H: case SRL_H:
+        READ(top, MEM_STACK);
+        WRITE(TARGET(d), kind_of(d->rt));
+        break;
+    case ADDI_H: case ANDI_H: case BORI_H: case NORI_H: case XORI_H:
+        READ(TARGET(d), kind_of(d->rt));
+        WRITE(TARGET(d), kind_of(d->rt));
+        break;
+    case BGEZ_H: case BGTZ_H: case BLEZ_H: case BLTZ_H: case JMP_H: case CSI_H:
+        READ(TARGET(d), kind_of(d->rt));
+        break;
+    case PSTR_H: {
+        //Every word of the string, up to the one holding its terminating NUL
+        for (int32_t a = TARGET(d); (uint32_t) a < vm->memory_words; a++) {
+            READ(a, kind_of(d->rt));
+            if (memchr(&vm->memory->words[a], 0, sizeof(word_type))) {
+                break;
+            }
+        }
+        WRITE(top, MEM_STACK);
+        break;
+    }
+    case PINT_H: case PCH_H:
+        READ(TARGET(d), kind_of(d->rt));
+        WRITE(top, MEM_STACK);
+        break;
+    default:
+        break;
+    }
+}
+
+#undef TARGET
+#undef SOURCE
+#undef READ
+#undef WRITE
+
+// Regions of the program's layout the report divides memory into
+typedef enum {REGION_TEXT, REGION_DATA, REGION_STACK, REGION_OTHER, NUM_REGIONS} region_type;
+
+static const char *region_names[NUM_REGIONS] = {"text", "data", "stack", "other"};
+
+static region_type region_of(VM *vm, int32_t addr) {
+    int32_t data = vm->bf_header.data_start_address;
+    int32_t data_end = data + vm->bf_header.data_length;
+    if (addr >= 0 && addr < vm->program_size) {
+        return REGION_TEXT;
+    } else if (addr >= data && addr < data_end) {
+        return REGION_DATA;
+    } else if (addr >= data_end && addr <= vm->bf_header.stack_bottom_addr) {
+        return REGION_STACK;
+    }
+    return REGION_OTHER;
+}
+
+// One word's counts, for the hottest-words list
+typedef struct {
+    int32_t addr;
+    uint64_t reads;
+    uint64_t writes;
+} word_counts;
+
+// Print the access counts by kind, a heatmap of each region's accessed
+// span, the reuse-distance histogram by kind, and the top most accessed
+// words, on out
+void memprof_report(mem_profile *m, VM *vm, FILE *out, int top) {
+    uint64_t reads = 0, writes = 0;
+    for (int k = 0; k < NUM_MEM_KINDS; k++) {
+        reads += m->reads[k];
+        writes += m->writes[k];
+    }
+    uint64_t total = reads + writes;
+    fprintf(out, "Memory profile: %llu reads, %llu writes to %u distinct words\n",
+            (unsigned long long) reads, (unsigned long long) writes, m->live);
+    fprintf(out, "%-18s %12s %12s %7s\n", "Addressed by", "Reads", "Writes", "%");
+    for (int k = 0; k < NUM_MEM_KINDS; k++) {
+        uint64_t n = m->reads[k] + m->writes[k];
+        fprintf(out, "%-18s %12llu %12llu %6.2f%%\n", kind_names[k], (unsigned long long) m->reads[k],
+                (unsigned long long) m->writes[k], total ? 100.0 * n / total : 0.0);
+    }
+
+    //Each region's accessed span, and the hottest words
+    int32_t lo[NUM_REGIONS], hi[NUM_REGIONS];
+    for (int r = 0; r < NUM_REGIONS; r++) {
+        lo[r] = INT32_MAX;
+        hi[r] = -1;
+    }
+    word_counts *hot = calloc(top > 0 ? top : 1, sizeof(word_counts));
+    if (!hot) {
+        perror("Error allocating memory profile report");
+        exit(EXIT_FAILURE);
+    }
+    int num_hot = 0;
+    for (uint32_t p = 0; p < VM_NUM_PAGES; p++) {
+        mem_page *page = m->pages[p];
+        for (int32_t i = 0; page && i < VM_PAGE_WORDS; i++) {
+            uint64_t n = page->reads[i] + page->writes[i];
+            if (n == 0) {
+                continue;
+            }
+            int32_t addr = (int32_t) (p << VM_PAGE_SHIFT) + i;
+            region_type r = region_of(vm, addr);
+            lo[r] = addr < lo[r] ? addr : lo[r];
+            hi[r] = addr > hi[r] ? addr : hi[r];
+            //Insert into the (decreasing) list of the top most accessed words
+            int j = num_hot < top ? num_hot++ : top;
+            while (j > 0 && hot[j - 1].reads + hot[j - 1].writes < n) {
+                if (j < top) {
+                    hot[j] = hot[j - 1];
+                }
+                j--;
+            }
+            if (j < top) {
+                hot[j] = (word_counts) {addr, page->reads[i], page->writes[i]};
+            }
+        }
+    }
+
+    fprintf(out, "Heatmap:\n");
+    for (int r = 0; r < NUM_REGIONS; r++) {
+        if (hi[r] < 0) {
+            continue;
+        }
+        uint32_t span = (uint32_t) (hi[r] - lo[r]) + 1;
+        uint32_t row_words = (span + HEATMAP_ROWS - 1) / HEATMAP_ROWS;
+        uint64_t rows[HEATMAP_ROWS][2] = {{0}};
+        uint64_t max = 0;
+        for (int32_t addr = lo[r]; addr <= hi[r]; addr++) {
+            mem_page *page = m->pages[addr >> VM_PAGE_SHIFT];
+            if (!page || region_of(vm, addr) != r) {
+                continue;
+            }
+            int32_t i = addr & (VM_PAGE_WORDS - 1);
+            uint64_t *row = rows[(addr - lo[r]) / row_words];
+            row[0] += page->reads[i];
+            row[1] += page->writes[i];
+            max = row[0] + row[1] > max ? row[0] + row[1] : max;
+        }
+        fprintf(out, "  %s, words %d to %d:\n", region_names[r], lo[r], hi[r]);
+        for (uint32_t row = 0; row * row_words < span; row++) {
+            int32_t start = lo[r] + row * row_words;
+            int32_t end = start + row_words - 1 < hi[r] ? start + row_words - 1 : hi[r];
+            uint64_t n = rows[row][0] + rows[row][1];
+            int bar = max ? (int) ((n * HEATMAP_WIDTH + max - 1) / max) : 0;
+            fprintf(out, "%10d-%-10d %12llu %12llu |%.*s\n", start, end, (unsigned long long) rows[row][0],
+                    (unsigned long long) rows[row][1], bar,
+                    "########################################");
+        }
+    }
+
+    fprintf(out, "Reuse distance (distinct words accessed in between):\n%-12s", "Distance");
+    for (int k = 0; k < NUM_MEM_KINDS; k++) {
+        fprintf(out, " %17s", kind_names[k]);
+    }
+    fputc('\n', out);
+    int last_bucket = 0;
+    for (int b = 0; b < MEM_REUSE_BUCKETS; b++) {
+        for (int k = 0; k < NUM_MEM_KINDS; k++) {
+            last_bucket = m->reuse[k][b] ? b : last_bucket;
+        }
+    }
+    for (int b = 0; b <= last_bucket; b++) {
+        char range[32];
+        if (b == 0) {
+            snprintf(range, sizeof(range), "first");
+        } else if (b <= 2) {
+            snprintf(range, sizeof(range), "%d", b - 1);
+        } else {
+            snprintf(range, sizeof(range), "%u-%u", 1u << (b - 2), (1u << (b - 1)) - 1);
+        }
+        fprintf(out, "%-12s", range);
+        for (int k = 0; k < NUM_MEM_KINDS; k++) {
+            fprintf(out, " %17llu", (unsigned long long) m->reuse[k][b]);
+        }
+        fputc('\n', out);
+    }
+
+    fprintf(out, "Hottest words:\n%10s %12s %12s Region\n", "Address", "Reads", "Writes");
+    for (int i = 0; i < num_hot; i++) {
+        fprintf(out, "%10d %12llu %12llu %s\n", hot[i].addr, (unsigned long long) hot[i].reads,
+                (unsigned long long) hot[i].writes, region_names[region_of(vm, hot[i].addr)]);
+    }
+    free(hot);
+}
@@ -0,0 +1,49 @@
+#ifndef MEMPROF_H
+#define MEMPROF_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "vm.h"
+
+// How a guest memory access got its address
+typedef enum {
+    MEM_GP,                     // $gp plus an offset
+    MEM_STACK,                  // $sp or $fp plus an offset (including the stack top)
+    MEM_OTHER,                  // another register plus an offset
+    MEM_INDIRECT,               // an address loaded from memory (LWI's second read)
+    NUM_MEM_KINDS
+} mem_kind;
+
+// Reuse distance buckets: first access, then distances 0, 1, 2-3, 4-7, ...
+#define MEM_REUSE_BUCKETS (VM_ADDRESS_BITS + 3)
+
+// Access counts for one page of guest memory
+typedef struct {
+    uint64_t reads[VM_PAGE_WORDS];
+    uint64_t writes[VM_PAGE_WORDS];
+    uint32_t last[VM_PAGE_WORDS]; // time slot of each word's last access, or 0
+} mem_page;
+
+// Guest memory access profile (vm -M)
+typedef struct mem_profile {
+    mem_page **pages;           // VM_NUM_PAGES entries, each allocated on its first access
+    uint64_t reads[NUM_MEM_KINDS];
+    uint64_t writes[NUM_MEM_KINDS];
+    uint64_t reuse[NUM_MEM_KINDS][MEM_REUSE_BUCKETS]; // accesses by reuse distance
+    // Reuse distances are counted with a Fenwick tree over time slots
+    // that has a 1 at each word's last access; slots are renumbered
+    // when they run out.
+    uint32_t *tree;             // the Fenwick tree, slots 1 to capacity
+    int32_t *slot_word;         // word last accessed at each slot, or -1
+    uint32_t capacity;
+    uint32_t now;               // last slot used
+    uint32_t live;              // distinct words accessed
+} mem_profile;
+
+// Function declarations
+mem_profile *memprof_create(void);
+void memprof_destroy(mem_profile *m);
+void memprof_step(mem_profile *m, VM *vm, const decoded_instr_t *d);
+void memprof_report(mem_profile *m, VM *vm, FILE *out, int top);
+
+#endif // MEMPROF_H
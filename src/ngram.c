@@ -0,0 +1,123 @@
+#include "ngram.h"
+#include <stdlib.h>
+#include <string.h>
+
+// A counted sequence, for sorting the report
+typedef struct {
+    uint64_t count;
+    int handlers[3];
+} ngram_entry;
+
+// Allocate an empty profile
+ngram_profile *ngram_create(void) {
+    ngram_profile *p = calloc(1, sizeof(ngram_profile));
+    if (!p) {
+        perror("Error allocating n-gram profile");
+        exit(EXIT_FAILURE);
+    }
+    p->last_addr = -2;
+    p->prev1 = -1;
+    p->prev2 = -1;
+    return p;
+}
+
+void ngram_destroy(ngram_profile *p) {
+    free(p);
+}
+
+// Record that the instruction at addr, run by handler h, is about to execute
+void ngram_record(ngram_profile *p, int32_t addr, handler_type h) {
+    if (h >= NUM_BASE_HANDLERS) {
+        return;
+    }
+    if (addr != p->last_addr + 1) {
+        //Control transferred here, so this starts a new sequence.
+        p->prev1 = -1;
+        p->prev2 = -1;
+    }
+    if (p->prev1 >= 0) {
+        p->bigrams[p->prev1][h]++;
+        if (p->prev2 >= 0) {
+            p->trigrams[p->prev2][p->prev1][h]++;
+        }
+    }
+    p->prev2 = p->prev1;
+    p->prev1 = h;
+    p->last_addr = addr;
+    p->instructions++;
+}
+
+// Sort entries by decreasing count
+static int compare_entries(const void *a, const void *b) {
+    const ngram_entry *x = a;
+    const ngram_entry *y = b;
+    if (x->count != y->count) {
+        return x->count < y->count ? 1 : -1;
+    }
+    return 0;
+}
+
+// Print the names of n handlers, without their "_H" suffixes
+static void print_sequence(FILE *out, const int *handlers, int n) {
+    char buffer[64];
+    int len = 0;
+    for (int i = 0; i < n; i++) {
+        const char *name = vm_handler_name(handlers[i]);
+        len += snprintf(buffer + len, sizeof(buffer) - len, "%s%.*s",
+                        i > 0 ? " " : "", (int) strlen(name) - 2, name);
+    }
+    fprintf(out, "%-16s", buffer);
+}
+
+// Print the top most frequent sequences of length n from entries
+static void report_entries(FILE *out, ngram_entry *entries, size_t count, int n, int top, uint64_t total) {
+    qsort(entries, count, sizeof(ngram_entry), compare_entries);
+    fprintf(out, "Top %s:\n", n == 2 ? "bigrams" : "trigrams");
+    for (size_t i = 0; i < count && i < (size_t) top; i++) {
+        fprintf(out, "  ");
+        print_sequence(out, entries[i].handlers, n);
+        fprintf(out, "%12llu  %5.1f%%\n", (unsigned long long) entries[i].count,
+                total ? 100.0 * entries[i].count / total : 0.0);
+    }
+}
+
+// Print the top most frequent bigrams and trigrams on out
+void ngram_report(ngram_profile *p, FILE *out, int top) {
+    size_t max = (size_t) NUM_BASE_HANDLERS * NUM_BASE_HANDLERS * NUM_BASE_HANDLERS;
+    ngram_entry *entries = malloc(max * sizeof(ngram_entry));
+    if (!entries) {
+        perror("Error allocating n-gram report");
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(out, "Instructions: %llu\n", (unsigned long long) p->instructions);
+    size_t count = 0;
+    for (int a = 0; a < NUM_BASE_HANDLERS; a++) {
+        for (int b = 0; b < NUM_BASE_HANDLERS; b++) {
+            if (p->bigrams[a][b] > 0) {
+                entries[count].count = p->bigrams[a][b];
+                entries[count].handlers[0] = a;
+                entries[count].handlers[1] = b;
+                count++;
+            }
+        }
+    }
+    report_entries(out, entries, count, 2, top, p->instructions);
+
+    count = 0;
+    for (int a = 0; a < NUM_BASE_HANDLERS; a++) {
+        for (int b = 0; b < NUM_BASE_HANDLERS; b++) {
+            for (int c = 0; c < NUM_BASE_HANDLERS; c++) {
+                if (p->trigrams[a][b][c] > 0) {
+                    entries[count].count = p->trigrams[a][b][c];
+                    entries[count].handlers[0] = a;
+                    entries[count].handlers[1] = b;
+                    entries[count].handlers[2] = c;
+                    count++;
+                }
+            }
+        }
+    }
+    report_entries(out, entries, count, 3, top, p->instructions);
+    free(entries);
+}
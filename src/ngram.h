@@ -0,0 +1,26 @@
+#ifndef NGRAM_H
+#define NGRAM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "vm.h"
+
+// Dynamic counts of opcode bigrams and trigrams (vm -n).
+// Only fall-through sequences are counted: a taken branch or jump starts
+// a new sequence, since only adjacent instructions can be fused.
+typedef struct ngram_profile {
+    uint64_t bigrams[NUM_BASE_HANDLERS][NUM_BASE_HANDLERS];
+    uint64_t trigrams[NUM_BASE_HANDLERS][NUM_BASE_HANDLERS][NUM_BASE_HANDLERS];
+    uint64_t instructions;      // instructions recorded
+    int32_t last_addr;          // address of the last instruction recorded
+    int prev1;                  // handler of the last instruction, -1 if none
+    int prev2;                  // handler of the one before it, -1 if none
+} ngram_profile;
+
+// Function declarations
+ngram_profile *ngram_create(void);
+void ngram_destroy(ngram_profile *p);
+void ngram_record(ngram_profile *p, int32_t addr, handler_type h);
+void ngram_report(ngram_profile *p, FILE *out, int top);
+
+#endif // NGRAM_H
@@ -0,0 +1,87 @@
+#include "profile.h"
+#include <stdlib.h>
+
+// Allocate an empty profile of a text section of size words
+pc_profile *profile_create(int32_t size) {
+    pc_profile *p = calloc(1, sizeof(pc_profile));
+    if (p) {
+        p->size = size;
+        p->counts = calloc(size > 0 ? size : 1, sizeof(uint64_t));
+        p->taken = calloc(size > 0 ? size : 1, sizeof(uint64_t));
+    }
+    if (!p || !p->counts || !p->taken) {
+        perror("Error allocating profile");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+void profile_destroy(pc_profile *p) {
+    if (!p) {
+        return;
+    }
+    free(p->counts);
+    free(p->taken);
+    free(p);
+}
+
+// Counts, for qsort to order addresses by
+static const uint64_t *sort_counts;
+
+// Sort addresses by decreasing count, then increasing address
+static int compare_addresses(const void *a, const void *b) {
+    int32_t x = *(const int32_t *) a;
+    int32_t y = *(const int32_t *) b;
+    if (sort_counts[x] != sort_counts[y]) {
+        return sort_counts[x] < sort_counts[y] ? 1 : -1;
+    }
+    return x < y ? -1 : x > y;
+}
+
+// Print the counts, share of all instructions run and (for branches) taken
+// and not-taken counts of the instruction at addr
+static void print_counts(pc_profile *p, FILE *out, int32_t addr, uint64_t total, handler_type h) {
+    char branch[48] = "";
+    if (PROFILE_IS_BRANCH(h)) {
+        snprintf(branch, sizeof(branch), "%llu/%llu", (unsigned long long) p->taken[addr],
+                 (unsigned long long) (p->counts[addr] - p->taken[addr]));
+    }
+    fprintf(out, "%12llu %6.2f%% %17s ", (unsigned long long) p->counts[addr],
+            total ? 100.0 * p->counts[addr] / total : 0.0, branch);
+}
+
+// Print the program listing (as vm -p does), each instruction prefixed
+// with its counts, then the top most frequently run addresses, on out
+void profile_report(pc_profile *p, VM *vm, FILE *out, int top) {
+    uint64_t total = p->outside;
+    for (int32_t i = 0; i < p->size; i++) {
+        total += p->counts[i];
+    }
+
+    fprintf(out, "Profile: %llu instructions", (unsigned long long) total);
+    if (p->outside) {
+        fprintf(out, " (%llu outside the text section)", (unsigned long long) p->outside);
+    }
+    fprintf(out, "\n%12s %7s %17s Address Instruction\n", "Count", "%", "Taken/not taken");
+    for (int32_t i = 0; i < p->size; i++) {
+        print_counts(p, out, i, total, vm->code[i].handler);
+        fprintf(out, "%6d: %s\n", i, vm_instruction_text(vm, i));
+    }
+
+    int32_t *order = malloc((p->size > 0 ? p->size : 1) * sizeof(int32_t));
+    if (!order) {
+        perror("Error allocating profile report");
+        exit(EXIT_FAILURE);
+    }
+    for (int32_t i = 0; i < p->size; i++) {
+        order[i] = i;
+    }
+    sort_counts = p->counts;
+    qsort(order, p->size, sizeof(int32_t), compare_addresses);
+    fprintf(out, "Hottest addresses:\n");
+    for (int32_t i = 0; i < p->size && i < top && p->counts[order[i]] > 0; i++) {
+        print_counts(p, out, order[i], total, vm->code[order[i]].handler);
+        fprintf(out, "%6d: %s\n", order[i], vm_instruction_text(vm, order[i]));
+    }
+    free(order);
+}
@@ -0,0 +1,36 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "vm.h"
+
+// Is h a conditional branch (one the profile keeps taken counts for)?
+#define PROFILE_IS_BRANCH(h) ((h) >= BEQ_H && (h) <= BNE_H)
+
+// Execution counts per text address (vm -P)
+typedef struct pc_profile {
+    int32_t size;               // text words counted
+    uint64_t *counts;           // times the instruction at each text address ran
+    uint64_t *taken;            // times the conditional branch at each text address was taken
+    uint64_t outside;           // instructions run outside the text section
+} pc_profile;
+
+// Record that the instruction at addr, run by handler h, left the PC at next_pc
+static inline void profile_record(pc_profile *p, int32_t addr, handler_type h, int32_t next_pc) {
+    if (addr < 0 || addr >= p->size) {
+        p->outside++;
+        return;
+    }
+    p->counts[addr]++;
+    if (PROFILE_IS_BRANCH(h) && next_pc != addr + 1) {
+        p->taken[addr]++;
+    }
+}
+
+// Function declarations
+pc_profile *profile_create(int32_t size);
+void profile_destroy(pc_profile *p);
+void profile_report(pc_profile *p, VM *vm, FILE *out, int top);
+
+#endif // PROFILE_H
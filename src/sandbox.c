@@ -0,0 +1,118 @@
+#include "sandbox.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "jit.h"
+
+// Sandboxed guest memory sits inside a reservation big enough that every
+// word index the engines can form lands in it: a signed 32-bit register
+// plus offset reaches 2^31 words below the base, and an unsigned PC 2^32
+// words above. All of the reservation but the guest's own words is
+// PROT_NONE, so a stray access raises SIGSEGV instead of touching the host,
+// and in-bounds accesses cost nothing extra.
+#define GUARD_BELOW ((size_t) 1 << 33)
+#define GUARD_ABOVE ((size_t) 1 << 34)
+
+static void *sandbox_alloc(size_t size, void *ctx) {
+    uint8_t *area = mmap(NULL, GUARD_BELOW + GUARD_ABOVE, PROT_NONE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (area == MAP_FAILED) {
+        return NULL;
+    }
+    if (mprotect(area + GUARD_BELOW, size, PROT_READ | PROT_WRITE) != 0) {
+        munmap(area, GUARD_BELOW + GUARD_ABOVE);
+        return NULL;
+    }
+    return area + GUARD_BELOW;
+}
+
+static void sandbox_release(void *mem, size_t size, void *ctx) {
+    munmap((uint8_t *) mem - GUARD_BELOW, GUARD_BELOW + GUARD_ABOVE);
+}
+
+static const vm_allocator sandbox_allocator = {sandbox_alloc, sandbox_release, NULL};
+
+// The VM vm_execute is running on this thread, and where to go when the
+// sandbox turns a stray access into a fault
+static __thread VM *armed_vm;
+static __thread sigjmp_buf *armed_catch;
+
+static void sandbox_handler(int sig, siginfo_t *info, void *context) {
+    VM *vm = armed_vm;
+    uintptr_t a = (uintptr_t) info->si_addr;
+    uintptr_t base = vm ? (uintptr_t) vm->memory : 0;
+    if (!vm || a < base - GUARD_BELOW || a >= base + GUARD_ABOVE) {
+        //Not a guest access: let the fault kill the process as usual.
+        signal(SIGSEGV, SIG_DFL);
+        return;
+    }
+
+    //The faulting instruction hasn't stored anything yet, so the guest's
+    //memory and registers are as they were when it started. Find it, and
+    //count the instructions started, from the engines' frames.
+    int32_t pc = vm->pc;
+    uint64_t started = 0;
+    bool innermost = true;
+    for (vm_frame *f = vm->frame; f; f = f->outer) {
+        started += *f->steps;
+        if (innermost) {
+            uint64_t native;
+#ifdef VM_JIT
+            if (jit_fault(vm->jit, context, vm, &pc, &native)) {
+                started += native;
+            } else
+#endif
+            if (!f->addr) {
+                started++;
+            } else {
+                pc = (int32_t) *f->addr;
+                if (f->first) {
+                    started += *f->addr - *f->first + 1;
+                }
+            }
+            innermost = false;
+        }
+    }
+    vm_fault(vm, pc, "memory access outside guest memory");
+    vm->pc = pc + 1;
+    vm->fault_steps = started;
+    sigjmp_buf *catch_fault = armed_catch;
+    vm_sandbox_disarm();
+    siglongjmp(*catch_fault, 1);
+}
+
+static pthread_once_t handler_once = PTHREAD_ONCE_INIT;
+
+static void install_handler(void) {
+    struct sigaction sa;
+    sa.sa_sigaction = sandbox_handler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_SIGINFO;
+    if (sigaction(SIGSEGV, &sa, NULL) != 0) {
+        perror("Error installing SIGSEGV handler");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Initialize the VM like vm_init, with its guest memory inside guard
+// regions: any access outside it stops the machine with a fault at the
+// instruction that made it, as vm_execute reports
+void vm_init_sandbox(VM *vm) {
+    pthread_once(&handler_once, install_handler);
+    vm_init_allocator(vm, &sandbox_allocator);
+    vm->sandbox = true;
+}
+
+// Send faults in vm's guard regions on this thread to catch_fault, until vm_sandbox_disarm
+void vm_sandbox_arm(VM *vm, sigjmp_buf *catch_fault) {
+    armed_vm = vm;
+    armed_catch = catch_fault;
+}
+
+void vm_sandbox_disarm(void) {
+    armed_vm = NULL;
+    armed_catch = NULL;
+}
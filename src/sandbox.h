@@ -0,0 +1,12 @@
+#ifndef SANDBOX_H
+#define SANDBOX_H
+
+#include <setjmp.h>
+#include "vm.h"
+
+// Function declarations
+void vm_init_sandbox(VM *vm);
+void vm_sandbox_arm(VM *vm, sigjmp_buf *catch_fault);
+void vm_sandbox_disarm(void);
+
+#endif // SANDBOX_H
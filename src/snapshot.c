@@ -0,0 +1,128 @@
+#include "snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void *snapshot_alloc(size_t size) {
+    void *p = calloc(1, size);
+    if (!p) {
+        perror("Error allocating snapshot");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+// Save vm's state and start tracking the pages it dirties from here on
+vm_snapshot *vm_snapshot_take(VM *vm) {
+    vm_snapshot *snap = snapshot_alloc(sizeof(vm_snapshot));
+    snap->pc = vm->pc;
+    snap->HI = vm->HI;
+    snap->LO = vm->LO;
+    memcpy(snap->registers, vm->registers, sizeof(snap->registers));
+    snap->tracing = vm->tracing;
+    snap->retired = vm->retired;
+    snap->num_touched = vm->num_touched;
+    snap->touched = snapshot_alloc((vm->num_touched > 0 ? vm->num_touched : 1) * sizeof(int32_t));
+    memcpy(snap->touched, vm->touched, vm->num_touched * sizeof(int32_t));
+
+    for (int dir = 0; dir < VM_NUM_DIRS; dir++) {
+        if (!vm->dirty_dirs[dir]) {
+            continue;
+        }
+        for (int i = 0; i < VM_DIR_PAGES; i++) {
+            uint32_t page = dir * VM_DIR_PAGES + i;
+            uint32_t first = page * VM_PAGE_WORDS;
+            if (!vm->dirty_pages[page] || first >= vm->memory_words) {
+                continue;
+            }
+            if (!snap->pages[dir]) {
+                snap->pages[dir] = snapshot_alloc(VM_DIR_PAGES * sizeof(word_type *));
+            }
+            snap->pages[dir][i] = snapshot_alloc(VM_PAGE_WORDS * sizeof(word_type));
+            memcpy(snap->pages[dir][i], &vm->memory->words[first], VM_PAGE_WORDS * sizeof(word_type));
+            vm->dirty_pages[page] = 0;
+        }
+        vm->dirty_dirs[dir] = 0;
+    }
+    return snap;
+}
+
+// Copy page (of directory entry dir, index i within it) back from snap,
+// or zero it if snap didn't save it. Text words that change are decoded
+// again through vm_text_written.
+static void restore_page(VM *vm, const vm_snapshot *snap, int dir, int i) {
+    uint32_t first = (dir * VM_DIR_PAGES + i) * VM_PAGE_WORDS;
+    if (first >= vm->memory_words) {
+        return;
+    }
+    const word_type *saved = snap->pages[dir] ? snap->pages[dir][i] : NULL;
+    for (uint32_t addr = first; addr < first + VM_PAGE_WORDS && addr < (uint32_t) vm->program_size; addr++) {
+        word_type word = saved ? saved[addr - first] : 0;
+        if (vm->memory->words[addr] != word) {
+            vm->memory->words[addr] = word;
+            vm_text_written(vm, addr);
+        }
+    }
+    if (saved) {
+        memcpy(&vm->memory->words[first], saved, VM_PAGE_WORDS * sizeof(word_type));
+    } else {
+        memset(&vm->memory->words[first], 0, VM_PAGE_WORDS * sizeof(word_type));
+    }
+}
+
+// Put vm back in the state saved in snap, ready to run again
+void vm_snapshot_restore(VM *vm, const vm_snapshot *snap) {
+    for (int dir = 0; dir < VM_NUM_DIRS; dir++) {
+        if (!vm->dirty_dirs[dir]) {
+            continue;
+        }
+        for (int i = 0; i < VM_DIR_PAGES; i++) {
+            uint8_t *dirty = &vm->dirty_pages[dir * VM_DIR_PAGES + i];
+            if (*dirty) {
+                restore_page(vm, snap, dir, i);
+                *dirty = 0;
+            }
+        }
+        vm->dirty_dirs[dir] = 0;
+    }
+
+    vm->pc = snap->pc;
+    vm->HI = snap->HI;
+    vm->LO = snap->LO;
+    memcpy(vm->registers, snap->registers, sizeof(vm->registers));
+    vm->tracing = snap->tracing;
+    vm->retired = snap->retired;
+    vm->state = VM_RUNNING;
+    vm->exit_code = 0;
+    vm->fault_pc = 0;
+    vm->fault_msg = NULL;
+
+    //The touched words only ever grow, so clearing the current ones'
+    //bits and setting the snapshot's puts the bitmap back.
+    for (int i = 0; i < vm->num_touched; i++) {
+        int32_t addr = vm->touched[i];
+        vm->touched_bits[addr >> VM_DIR_SHIFT][(addr & (VM_DIR_WORDS - 1)) / 64] &= ~(1ULL << (addr % 64));
+    }
+    for (int i = 0; i < snap->num_touched; i++) {
+        int32_t addr = snap->touched[i];
+        vm->touched_bits[addr >> VM_DIR_SHIFT][(addr & (VM_DIR_WORDS - 1)) / 64] |= 1ULL << (addr % 64);
+    }
+    memcpy(vm->touched, snap->touched, snap->num_touched * sizeof(int32_t));
+    vm->num_touched = snap->num_touched;
+}
+
+void vm_snapshot_free(vm_snapshot *snap) {
+    if (!snap) {
+        return;
+    }
+    for (int dir = 0; dir < VM_NUM_DIRS; dir++) {
+        if (snap->pages[dir]) {
+            for (int i = 0; i < VM_DIR_PAGES; i++) {
+                free(snap->pages[dir][i]);
+            }
+            free(snap->pages[dir]);
+        }
+    }
+    free(snap->touched);
+    free(snap);
+}
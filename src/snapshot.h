@@ -0,0 +1,28 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "vm.h"
+
+// A saved machine state to rerun a loaded program from (vm --inputs).
+// Only pages that had been stored into are saved, in the same two-level
+// layout as the VM's page table; every other page was all zeros.
+// Restoring copies back only the pages stored into since the snapshot
+// was taken or last restored, found from vm->dirty_dirs and vm->dirty_pages.
+typedef struct vm_snapshot {
+    int32_t pc;
+    int32_t HI;
+    int32_t LO;
+    int32_t registers[NUM_REGISTERS];
+    bool tracing;
+    uint64_t retired;
+    int32_t *touched;
+    int32_t num_touched;
+    word_type **pages[VM_NUM_DIRS]; // saved pages by directory entry (NULL when none were saved)
+} vm_snapshot;
+
+// Function declarations
+vm_snapshot *vm_snapshot_take(VM *vm);
+void vm_snapshot_restore(VM *vm, const vm_snapshot *snap);
+void vm_snapshot_free(vm_snapshot *snap);
+
+#endif // SNAPSHOT_H
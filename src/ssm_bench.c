@@ -0,0 +1,299 @@
+// ssm-bench: time the VM on a set of programs and report JSON.
+// Runs "vm -q [engine flags] program" a few times per program and engine,
+// and prints one result per line: guest instructions, the median wall
+// time, MIPS and peak resident set size. Given a baseline (an earlier
+// report), it also lists the results that got slower, and exits with
+// a failure status if there are any.
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+// Defaults for -r and --threshold
+#define BENCH_RUNS 3
+#define BENCH_THRESHOLD 10.0
+
+// Most engines (-e) and engine flags
+#define BENCH_MAX_ENGINES 8
+#define BENCH_MAX_FLAGS 8
+
+// Longest report line read from a baseline or vm's output
+#define BENCH_LINE 1024
+
+// One run of the VM
+typedef struct {
+    double seconds;             // wall time
+    long max_rss_kb;            // peak resident set size
+    unsigned long long instructions;
+} bench_run;
+
+// A result read from a baseline
+typedef struct {
+    char *program;
+    char *engine;
+    double mips;
+} baseline_result;
+
+static baseline_result *baseline;
+static int num_baseline;
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-r RUNS] [--vm PATH] [-e FLAGS]... [-o FILE]\n"
+            "          [--baseline FILE [--threshold PERCENT]] <program.bof>...\n", prog);
+    fprintf(stderr, "  -r RUNS  runs of each program per engine; the median is reported (default %d)\n",
+            BENCH_RUNS);
+    fprintf(stderr, "  --vm PATH  the VM to time (default ./vm)\n");
+    fprintf(stderr, "  -e FLAGS  vm flags selecting an engine, e.g. \"-t\"; repeat to time several\n"
+            "            (default: the switch engine alone)\n");
+    fprintf(stderr, "  -o FILE  write the JSON report to FILE instead of stdout\n");
+    fprintf(stderr, "  --baseline FILE  compare MIPS with an earlier report; list slowdowns and fail if there are any\n");
+    fprintf(stderr, "  --threshold PERCENT  slowdown worth listing (default %.0f)\n", BENCH_THRESHOLD);
+    exit(EXIT_FAILURE);
+}
+
+static double now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+// Run vm with argv once, reading its output for the instruction count
+// on the last line. Exits if it can't run or the program fails.
+static bench_run run_once(char **argv) {
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) {
+        perror("pipe");
+        exit(EXIT_FAILURE);
+    }
+    double start = now();
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(EXIT_FAILURE);
+    }
+    if (pid == 0) {
+        int null_fd = open("/dev/null", O_RDWR);
+        dup2(null_fd, STDIN_FILENO);
+        dup2(pipe_fds[1], STDOUT_FILENO);
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        execv(argv[0], argv);
+        perror(argv[0]);
+        _exit(127);
+    }
+    close(pipe_fds[1]);
+
+    //Keep the last complete line
+    FILE *out = fdopen(pipe_fds[0], "r");
+    char line[BENCH_LINE], last[BENCH_LINE] = "";
+    while (fgets(line, sizeof(line), out)) {
+        if (strchr(line, '\n')) {
+            strcpy(last, line);
+        }
+    }
+    fclose(out);
+
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) != pid) {
+        perror("wait4");
+        exit(EXIT_FAILURE);
+    }
+    bench_run r;
+    r.seconds = now() - start;
+    r.max_rss_kb = usage.ru_maxrss;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "%s failed (%s %d)\n", argv[0], WIFEXITED(status) ? "exit status" : "signal",
+                WIFEXITED(status) ? WEXITSTATUS(status) : WTERMSIG(status));
+        exit(EXIT_FAILURE);
+    }
+    if (sscanf(last, "%llu instructions", &r.instructions) != 1) {
+        fprintf(stderr, "%s: no instruction count in its output\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    return r;
+}
+
+static int compare_seconds(const void *a, const void *b) {
+    const bench_run *x = a, *y = b;
+    return x->seconds < y->seconds ? -1 : x->seconds > y->seconds;
+}
+
+// Copy the JSON string value of key in line into value (no escapes are
+// written, so none are read); returns false if line doesn't have key
+static bool json_string(const char *line, const char *key, char *value, size_t size) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\": \"", key);
+    const char *p = strstr(line, pattern);
+    if (!p) {
+        return false;
+    }
+    p += strlen(pattern);
+    const char *end = strchr(p, '"');
+    if (!end || (size_t) (end - p) >= size) {
+        return false;
+    }
+    memcpy(value, p, end - p);
+    value[end - p] = '\0';
+    return true;
+}
+
+static bool json_number(const char *line, const char *key, double *value) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\": ", key);
+    const char *p = strstr(line, pattern);
+    return p && sscanf(p + strlen(pattern), "%lf", value) == 1;
+}
+
+// Read the results of a report written by this program (one per line)
+static void load_baseline(const char *filename) {
+    FILE *f = fopen(filename, "r");
+    if (!f) {
+        perror(filename);
+        exit(EXIT_FAILURE);
+    }
+    char line[BENCH_LINE], program[BENCH_LINE], engine[BENCH_LINE];
+    double mips;
+    int capacity = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (!json_string(line, "program", program, sizeof(program))
+            || !json_string(line, "engine", engine, sizeof(engine))
+            || !json_number(line, "mips", &mips)) {
+            continue;
+        }
+        if (num_baseline == capacity) {
+            capacity = capacity ? 2 * capacity : 16;
+            baseline = realloc(baseline, capacity * sizeof(baseline_result));
+            if (!baseline) {
+                perror("Error allocating baseline");
+                exit(EXIT_FAILURE);
+            }
+        }
+        baseline[num_baseline].program = strdup(program);
+        baseline[num_baseline].engine = strdup(engine);
+        baseline[num_baseline].mips = mips;
+        num_baseline++;
+    }
+    fclose(f);
+}
+
+static baseline_result *find_baseline(const char *program, const char *engine) {
+    for (int i = 0; i < num_baseline; i++) {
+        if (strcmp(baseline[i].program, program) == 0 && strcmp(baseline[i].engine, engine) == 0) {
+            return &baseline[i];
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    int runs = BENCH_RUNS;
+    char *vm_path = "./vm";
+    char *engines[BENCH_MAX_ENGINES];
+    int num_engines = 0;
+    const char *output = NULL;
+    const char *baseline_file = NULL;
+    double threshold = BENCH_THRESHOLD;
+
+    int argi = 1;
+    for (; argi < argc && argv[argi][0] == '-'; argi++) {
+        if (strcmp(argv[argi], "-r") == 0 && argi + 1 < argc) {
+            runs = atoi(argv[++argi]);
+            if (runs < 1) {
+                usage(argv[0]);
+            }
+        } else if (strcmp(argv[argi], "--vm") == 0 && argi + 1 < argc) {
+            vm_path = argv[++argi];
+        } else if (strcmp(argv[argi], "-e") == 0 && argi + 1 < argc && num_engines < BENCH_MAX_ENGINES) {
+            engines[num_engines++] = argv[++argi];
+        } else if (strcmp(argv[argi], "-o") == 0 && argi + 1 < argc) {
+            output = argv[++argi];
+        } else if (strcmp(argv[argi], "--baseline") == 0 && argi + 1 < argc) {
+            baseline_file = argv[++argi];
+        } else if (strcmp(argv[argi], "--threshold") == 0 && argi + 1 < argc) {
+            threshold = atof(argv[++argi]);
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (argi == argc) {
+        usage(argv[0]);
+    }
+    if (num_engines == 0) {
+        engines[num_engines++] = "";
+    }
+    if (baseline_file) {
+        load_baseline(baseline_file);
+    }
+    FILE *out = stdout;
+    if (output && !(out = fopen(output, "w"))) {
+        perror(output);
+        exit(EXIT_FAILURE);
+    }
+    bench_run *results = malloc(runs * sizeof(bench_run));
+    if (!results) {
+        perror("Error allocating results");
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(out, "{\"vm\": \"%s\", \"runs\": %d, \"results\": [\n", vm_path, runs);
+    int slower = 0;
+    bool first = true;
+    for (int p = argi; p < argc; p++) {
+        for (int e = 0; e < num_engines; e++) {
+            //vm_path, the engine's flags split at spaces, -q, the program
+            char flags[BENCH_LINE];
+            char *vm_argv[BENCH_MAX_FLAGS + 4];
+            int n = 0;
+            vm_argv[n++] = vm_path;
+            snprintf(flags, sizeof(flags), "%s", engines[e]);
+            for (char *f = strtok(flags, " "); f && n < BENCH_MAX_FLAGS + 1; f = strtok(NULL, " ")) {
+                vm_argv[n++] = f;
+            }
+            vm_argv[n++] = "-q";
+            vm_argv[n++] = argv[p];
+            vm_argv[n] = NULL;
+
+            long max_rss_kb = 0;
+            for (int r = 0; r < runs; r++) {
+                results[r] = run_once(vm_argv);
+                max_rss_kb = results[r].max_rss_kb > max_rss_kb ? results[r].max_rss_kb : max_rss_kb;
+            }
+            qsort(results, runs, sizeof(bench_run), compare_seconds);
+            double seconds = results[runs / 2].seconds;
+            double mips = results[0].instructions / seconds / 1e6;
+
+            fprintf(out, "%s  {\"program\": \"%s\", \"engine\": \"%s\", \"instructions\": %llu, "
+                    "\"seconds\": %.4f, \"best_seconds\": %.4f, \"mips\": %.2f, \"max_rss_kb\": %ld}",
+                    first ? "" : ",\n", argv[p], engines[e], results[0].instructions,
+                    seconds, results[0].seconds, mips, max_rss_kb);
+            first = false;
+            fprintf(stderr, "%-24s %-6s %8.2f MIPS %9.4f s %8ld KB", argv[p], engines[e][0] ? engines[e] : "switch",
+                    mips, seconds, max_rss_kb);
+            baseline_result *b = baseline_file ? find_baseline(argv[p], engines[e]) : NULL;
+            if (b && b->mips > 0) {
+                double change = 100.0 * (mips - b->mips) / b->mips;
+                fprintf(stderr, " %+7.1f%% vs baseline%s", change, change < -threshold ? "  SLOWER" : "");
+                slower += change < -threshold;
+            }
+            fputc('\n', stderr);
+        }
+    }
+    fprintf(out, "\n]}\n");
+    if (out != stdout && fclose(out) != 0) {
+        perror(output);
+        exit(EXIT_FAILURE);
+    }
+    if (slower) {
+        fprintf(stderr, "%d result%s more than %.0f%% slower than %s\n", slower, slower == 1 ? " is" : "s are",
+                threshold, baseline_file);
+    }
+    free(results);
+    return slower ? EXIT_FAILURE : EXIT_SUCCESS;
+}
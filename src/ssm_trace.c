@@ -0,0 +1,149 @@
+// ssm-trace: decode a binary trace written by vm --trace-bin.
+// Replays the trace against the program's BOF image and prints the same
+// text vm prints when run without --trace-bin.
+#include "vm.h"
+#include "trace.h"
+#include "trace_bin.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static FILE *in;
+static const char *in_name;
+
+static void corrupt(void) {
+    fprintf(stderr, "%s: truncated or corrupt trace\n", in_name);
+    exit(EXIT_FAILURE);
+}
+
+static uint8_t get_byte(void) {
+    int c = getc(in);
+    if (c == EOF) {
+        corrupt();
+    }
+    return (uint8_t) c;
+}
+
+static uint32_t get_varint(void) {
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        uint8_t b = get_byte();
+        v |= (uint32_t) (b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            return v;
+        }
+    }
+    corrupt();
+    return 0;
+}
+
+static int32_t get_signed(void) {
+    uint32_t v = get_varint();
+    return (int32_t) ((v >> 1) ^ (0u - (v & 1)));
+}
+
+// Read count (address delta, value) pairs into memory, marking the words touched
+static void get_words(VM *vm, uint32_t count) {
+    int32_t addr = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        addr += get_signed();
+        if ((uint32_t) addr >= vm->memory_words) {
+            corrupt();
+        }
+        vm_set_word(vm, addr, get_signed());
+        vm_touch(vm, addr);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <program.bof> <trace file>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    in_name = argv[2];
+    in = fopen(in_name, "rb");
+    if (!in) {
+        perror("Error opening trace file");
+        return EXIT_FAILURE;
+    }
+    char magic[sizeof(TRACE_BIN_MAGIC) - 1];
+    if (fread(magic, 1, sizeof(magic), in) != sizeof(magic)
+        || memcmp(magic, TRACE_BIN_MAGIC, sizeof(magic)) != 0) {
+        fprintf(stderr, "%s: not a binary SSM trace\n", in_name);
+        return EXIT_FAILURE;
+    }
+    if (get_byte() != TRACE_BIN_VERSION) {
+        fprintf(stderr, "%s: unsupported trace version\n", in_name);
+        return EXIT_FAILURE;
+    }
+
+    VM vm;
+    vm_init(&vm);
+    vm_load_program(&vm, argv[1]);
+    int32_t next_pc = vm.pc;
+    int32_t step_pc = vm.pc;
+
+    for (;;) {
+        switch (get_byte()) {
+            case TRACE_BIN_SYNC: {
+                vm.pc = get_signed();
+                for (int i = 0; i < NUM_REGISTERS; i++) {
+                    vm.registers[i] = get_signed();
+                }
+                get_words(&vm, get_varint());
+                uint32_t text = get_varint();
+                if (text != 0 && text != (uint32_t) vm.program_size) {
+                    corrupt();
+                }
+                for (uint32_t i = 0; i < text; i++) {
+                    vm_set_word(&vm, i, (word_type) get_varint());
+                }
+                print_registers(&vm);
+                print_words(&vm);
+                next_pc = vm.pc;
+                break;
+            }
+            case TRACE_BIN_STEP:
+                step_pc = next_pc + get_signed();
+                if (step_pc < 0 || step_pc >= vm.program_size) {
+                    if ((uint32_t) step_pc >= vm.memory_words) {
+                        corrupt();
+                    }
+                    vm_set_word(&vm, step_pc, (word_type) get_varint());
+                }
+                print_instruction(&vm, step_pc);
+                break;
+            case TRACE_BIN_OUTPUT: {
+                uint32_t n = get_varint();
+                trace_flush(vm.trace);
+                for (uint32_t i = 0; i < n; i++) {
+                    putchar(get_byte());
+                }
+                break;
+            }
+            case TRACE_BIN_END: {
+                uint8_t flags = get_byte();
+                vm.pc = step_pc + 1 + get_signed();
+                uint8_t mask = get_byte();
+                for (int i = 0; i < NUM_REGISTERS; i++) {
+                    if (mask & (1 << i)) {
+                        vm.registers[i] = (int32_t) ((uint32_t) vm.registers[i] + (uint32_t) get_signed());
+                    }
+                }
+                get_words(&vm, get_varint());
+                if (flags & TRACE_BIN_PRINT) {
+                    print_registers(&vm);
+                    print_words(&vm);
+                }
+                next_pc = vm.pc;
+                break;
+            }
+            case TRACE_BIN_DONE:
+                vm_free(&vm);
+                fclose(in);
+                return EXIT_SUCCESS;
+            default:
+                corrupt();
+        }
+    }
+}
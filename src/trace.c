@@ -0,0 +1,56 @@
+#include "trace.h"
+#include <stdlib.h>
+
+// Longest text trace_int produces without padding ("-2147483648")
+#define MAX_INT_CHARS 11
+
+// Allocate an empty buffer for text going to out
+trace_buffer *trace_create(FILE *out) {
+    trace_buffer *tb = malloc(sizeof(trace_buffer));
+    if (!tb) {
+        perror("Error allocating trace buffer");
+        exit(EXIT_FAILURE);
+    }
+    tb->out = out;
+    tb->len = 0;
+    return tb;
+}
+
+// Write out what is left and free the buffer
+void trace_destroy(trace_buffer *tb) {
+    if (!tb) {
+        return;
+    }
+    trace_flush(tb);
+    free(tb);
+}
+
+void trace_drain(trace_buffer *tb) {
+    fwrite(tb->buf, 1, tb->len, tb->out);
+    tb->len = 0;
+}
+
+// Append value in decimal, right-aligned in width columns (like "%*d");
+// returns the number of characters appended
+int trace_int(trace_buffer *tb, int32_t value, int width) {
+    char digits[MAX_INT_CHARS];
+    int n = 0;
+    uint32_t u = value < 0 ? 0u - (uint32_t) value : (uint32_t) value;
+    do {
+        digits[MAX_INT_CHARS - 1 - n++] = (char) ('0' + u % 10);
+        u /= 10;
+    } while (u);
+    if (value < 0) {
+        digits[MAX_INT_CHARS - 1 - n++] = '-';
+    }
+    int padded = n > width ? n : width;
+    if (tb->len + padded > TRACE_BUFFER_SIZE) {
+        trace_drain(tb);
+    }
+    for (; width > n; width--) {
+        tb->buf[tb->len++] = ' ';
+    }
+    memcpy(tb->buf + tb->len, digits + MAX_INT_CHARS - n, n);
+    tb->len += n;
+    return padded;
+}
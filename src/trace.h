@@ -0,0 +1,59 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+// Bytes of trace text collected before it is written out
+#define TRACE_BUFFER_SIZE (1 << 20)
+
+// Buffered trace output. The print_* functions append text here and it
+// goes out in large fwrite calls. Anything else that writes to the same
+// stream (the guest's PSTR/PINT/PCH) must call trace_flush first.
+typedef struct trace_buffer {
+    FILE *out;
+    size_t len;                 // bytes waiting in buf
+    char buf[TRACE_BUFFER_SIZE];
+} trace_buffer;
+
+// Function declarations
+trace_buffer *trace_create(FILE *out);
+void trace_destroy(trace_buffer *tb);
+void trace_drain(trace_buffer *tb);
+int trace_int(trace_buffer *tb, int32_t value, int width);
+
+// Write out everything buffered so far
+static inline void trace_flush(trace_buffer *tb) {
+    if (tb->len) {
+        trace_drain(tb);
+    }
+}
+
+// Append n bytes
+static inline void trace_bytes(trace_buffer *tb, const char *s, size_t n) {
+    if (tb->len + n > TRACE_BUFFER_SIZE) {
+        trace_drain(tb);
+        if (n > TRACE_BUFFER_SIZE) {
+            fwrite(s, 1, n, tb->out);
+            return;
+        }
+    }
+    memcpy(tb->buf + tb->len, s, n);
+    tb->len += n;
+}
+
+// Append a NUL-terminated string
+static inline void trace_str(trace_buffer *tb, const char *s) {
+    trace_bytes(tb, s, strlen(s));
+}
+
+// Append one character
+static inline void trace_char(trace_buffer *tb, char c) {
+    if (tb->len == TRACE_BUFFER_SIZE) {
+        trace_drain(tb);
+    }
+    tb->buf[tb->len++] = c;
+}
+
+#endif // TRACE_H
@@ -0,0 +1,175 @@
+#include "trace_bin.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Longest LEB128 encoding of a 32-bit value
+#define MAX_VARINT_BYTES 5
+
+// A record being assembled before it is written out
+typedef struct {
+    uint8_t bytes[1 + 3 * MAX_VARINT_BYTES + (NUM_REGISTERS + 1) * MAX_VARINT_BYTES
+                  + TRACE_BIN_MAX_WORDS * 2 * MAX_VARINT_BYTES];
+    size_t len;
+} record;
+
+static void put_byte(record *r, uint8_t b) {
+    r->bytes[r->len++] = b;
+}
+
+static void put_varint(record *r, uint32_t v) {
+    while (v >= 0x80) {
+        put_byte(r, (uint8_t) (v | 0x80));
+        v >>= 7;
+    }
+    put_byte(r, (uint8_t) v);
+}
+
+static void put_signed(record *r, int32_t v) {
+    put_varint(r, ((uint32_t) v << 1) ^ (uint32_t) (v >> 31));
+}
+
+static void put_record(trace_bin *tb, record *r) {
+    fwrite(r->bytes, 1, r->len, tb->out);
+    r->len = 0;
+}
+
+// Create the trace file and write its header
+trace_bin *trace_bin_open(const char *filename) {
+    trace_bin *tb = calloc(1, sizeof(trace_bin));
+    if (!tb) {
+        perror("Error allocating binary trace");
+        exit(EXIT_FAILURE);
+    }
+    tb->out = fopen(filename, "wb");
+    if (!tb->out) {
+        perror("Error opening binary trace file");
+        exit(EXIT_FAILURE);
+    }
+    fwrite(TRACE_BIN_MAGIC, 1, strlen(TRACE_BIN_MAGIC), tb->out);
+    fputc(TRACE_BIN_VERSION, tb->out);
+    return tb;
+}
+
+// Write the DONE record and close the file
+void trace_bin_close(trace_bin *tb) {
+    if (!tb) {
+        return;
+    }
+    fputc(TRACE_BIN_DONE, tb->out);
+    if (fclose(tb->out) != 0) {
+        perror("Error writing binary trace file");
+    }
+    free(tb);
+}
+
+// Record the whole printed state of vm
+void trace_bin_sync(trace_bin *tb, VM *vm) {
+    record r = {.len = 0};
+    put_byte(&r, TRACE_BIN_SYNC);
+    put_signed(&r, vm->pc);
+    for (int i = 0; i < NUM_REGISTERS; i++) {
+        put_signed(&r, vm->registers[i]);
+    }
+    put_varint(&r, (uint32_t) vm->num_touched);
+    put_record(tb, &r);
+    int32_t last = 0;
+    for (int i = 0; i < vm->num_touched; i++) {
+        put_signed(&r, vm->touched[i] - last);
+        put_signed(&r, vm_get_word(vm, vm->touched[i]));
+        last = vm->touched[i];
+        put_record(tb, &r);
+    }
+    //The trace only follows the text through traced stores.
+    bool text_changed = vm->text_writes != tb->text_writes;
+    put_varint(&r, text_changed ? (uint32_t) vm->program_size : 0);
+    put_record(tb, &r);
+    if (text_changed) {
+        for (int i = 0; i < vm->program_size; i++) {
+            put_varint(&r, (uint32_t) vm_get_word(vm, i));
+            put_record(tb, &r);
+        }
+    }
+    tb->next_pc = vm->pc;
+    tb->text_writes = vm->text_writes;
+}
+
+// Record that the traced instruction at vm->pc is about to run
+void trace_bin_step(trace_bin *tb, VM *vm) {
+    record r = {.len = 0};
+    put_byte(&r, TRACE_BIN_STEP);
+    put_signed(&r, vm->pc - tb->next_pc);
+    if (vm->pc < 0 || vm->pc >= vm->program_size) {
+        put_varint(&r, (uint32_t) vm_get_word(vm, vm->pc));
+    }
+    put_record(tb, &r);
+    tb->step_pc = vm->pc;
+    memcpy(tb->old_registers, vm->registers, sizeof(tb->old_registers));
+    tb->num_words = 0;
+    tb->words_overflow = false;
+    tb->in_step = true;
+}
+
+// Record that the traced instruction stored into, or first touched, the word at addr
+void trace_bin_word(trace_bin *tb, int32_t addr) {
+    if (!tb->in_step) {
+        return;
+    }
+    if (tb->num_words == TRACE_BIN_MAX_WORDS) {
+        tb->words_overflow = true;
+        return;
+    }
+    tb->words[tb->num_words++] = addr;
+}
+
+// Record bytes the guest wrote to stdout
+void trace_bin_output(trace_bin *tb, const char *bytes, size_t n) {
+    record r = {.len = 0};
+    put_byte(&r, TRACE_BIN_OUTPUT);
+    put_varint(&r, (uint32_t) n);
+    put_record(tb, &r);
+    fwrite(bytes, 1, n, tb->out);
+}
+
+// Record what the traced instruction changed; print says whether vm prints the state now
+void trace_bin_end(trace_bin *tb, VM *vm, bool print) {
+    record r = {.len = 0};
+    put_byte(&r, TRACE_BIN_END);
+    put_byte(&r, print ? TRACE_BIN_PRINT : 0);
+    put_signed(&r, vm->pc - (tb->step_pc + 1));
+    uint8_t mask = 0;
+    for (int i = 0; i < NUM_REGISTERS; i++) {
+        if (vm->registers[i] != tb->old_registers[i]) {
+            mask |= 1 << i;
+        }
+    }
+    put_byte(&r, mask);
+    for (int i = 0; i < NUM_REGISTERS; i++) {
+        if (mask & (1 << i)) {
+            put_signed(&r, (int32_t) ((uint32_t) vm->registers[i] - (uint32_t) tb->old_registers[i]));
+        }
+    }
+    if (tb->words_overflow) {
+        //Too many to list one by one: send every touched word.
+        put_varint(&r, (uint32_t) vm->num_touched);
+        put_record(tb, &r);
+        int32_t last = 0;
+        for (int i = 0; i < vm->num_touched; i++) {
+            put_signed(&r, vm->touched[i] - last);
+            put_signed(&r, vm_get_word(vm, vm->touched[i]));
+            last = vm->touched[i];
+            put_record(tb, &r);
+        }
+    } else {
+        put_varint(&r, (uint32_t) tb->num_words);
+        int32_t last = 0;
+        for (int i = 0; i < tb->num_words; i++) {
+            put_signed(&r, tb->words[i] - last);
+            put_signed(&r, vm_get_word(vm, tb->words[i]));
+            last = tb->words[i];
+        }
+        put_record(tb, &r);
+    }
+    tb->next_pc = vm->pc;
+    tb->text_writes = vm->text_writes;
+    tb->in_step = false;
+}
@@ -0,0 +1,68 @@
+#ifndef TRACE_BIN_H
+#define TRACE_BIN_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "vm.h"
+
+// Binary execution trace (vm --trace-bin FILE), decoded by ssm-trace.
+//
+// The file starts with TRACE_BIN_MAGIC and TRACE_BIN_VERSION, followed by
+// records that each start with a tag byte. Integers are LEB128 varints;
+// signed ones are zigzag-encoded first, so small deltas take one byte.
+//
+//   SYNC    the whole printed state, written where vm prints registers and
+//           words without a traced instruction before them (at the start,
+//           and when STRA turns tracing back on): pc, the 8 GPRs, every
+//           touched word as (address delta, value), then the text section
+//           if it was stored into while tracing was off (count, words)
+//   STEP    a traced instruction is about to run: its address as a delta
+//           from the PC after the last record, and its instruction word if
+//           it is outside the text section
+//   OUTPUT  bytes the guest wrote to stdout (count, bytes)
+//   END     the traced instruction finished: a flags byte (TRACE_BIN_PRINT
+//           if vm prints the state now), the new PC as a delta from the
+//           instruction's address + 1, a mask of the GPRs that changed and
+//           their deltas, then the words it stored or touched for the first
+//           time as (address delta, value)
+//   DONE    the end of the trace
+#define TRACE_BIN_MAGIC "SSMT"
+#define TRACE_BIN_VERSION 1
+
+typedef enum {
+    TRACE_BIN_SYNC = 1,
+    TRACE_BIN_STEP,
+    TRACE_BIN_OUTPUT,
+    TRACE_BIN_END,
+    TRACE_BIN_DONE
+} trace_bin_tag;
+
+// END flag: the registers and words are printed after this instruction
+#define TRACE_BIN_PRINT 0x1
+
+// Most words one instruction can store or touch
+#define TRACE_BIN_MAX_WORDS 16
+
+typedef struct trace_bin {
+    FILE *out;
+    int32_t next_pc;            // PC after the last record, the base of STEP's delta
+    int32_t step_pc;            // address of the instruction being traced
+    int32_t old_registers[NUM_REGISTERS]; // GPRs before it
+    bool in_step;               // between STEP and END
+    int num_words;
+    int32_t words[TRACE_BIN_MAX_WORDS]; // addresses it stored or first touched
+    bool words_overflow;        // more than TRACE_BIN_MAX_WORDS; END sends all touched words
+    uint32_t text_writes;       // vm->text_writes as of the last record
+} trace_bin;
+
+// Function declarations
+trace_bin *trace_bin_open(const char *filename);
+void trace_bin_close(trace_bin *tb);
+void trace_bin_sync(trace_bin *tb, VM *vm);
+void trace_bin_step(trace_bin *tb, VM *vm);
+void trace_bin_word(trace_bin *tb, int32_t addr);
+void trace_bin_output(trace_bin *tb, const char *bytes, size_t n);
+void trace_bin_end(trace_bin *tb, VM *vm, bool print);
+
+#endif // TRACE_BIN_H
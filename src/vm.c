@@ -1,468 +1,1400 @@
-#include "vm.h"
-#include <stdio.h>
-#include <stdlib.h>
-#include "../provided/bof.h"
-#include "../provided/machine_types.h"
-#include "../provided/regname.h"
-#include "../provided/instruction.h"
-
-// Initialize the VM with default values
-void vm_init(VM *vm) {
-    vm->ip = 0;  // Instruction pointer starts at the first instruction
-    vm->program_size = 0;  // No program loaded initially
-    vm->pc = 0;
-    vm->tracing = true;
-    for (int i = 0; i < NUM_REGISTERS; i++) {
-        vm->registers[i] = 0; 
-    }
-}
-
-static union mem_u {
-    word_type words[MEMORY_SIZE_IN_WORDS];
-    uword_type uwords[MEMORY_SIZE_IN_WORDS];
-    bin_instr_t instrs[MEMORY_SIZE_IN_WORDS];
-} memory;
-
-// Load the program (instructions) into the VM with debugging
-void vm_load_program(VM *vm, const char *filename) {
-    FILE *file = fopen(filename, "rb");
-    if (!file) {
-        perror("Error opening file");
-        exit(EXIT_FAILURE);
-    }
-
-    // Read the instructions into the program array
-    BOFFILE bf_file = bof_read_open(filename);
-    BOFHeader bf_header = bof_read_header(bf_file);
-    vm->bf_header = bf_header; 
-
-    vm->pc = bf_header.text_start_address;
-    vm->registers[0] = bf_header.data_start_address;
-    vm->registers[1] = bf_header.stack_bottom_addr;
-    vm->registers[2] = bf_header.stack_bottom_addr;
-
-    vm->program_size = bf_header.text_length;
-
-    for (int i = 0; i < vm->program_size; i++) {
-        memory.instrs[i] = instruction_read(bf_file);
-    }
-    //System used to track which data values we want to use in the output, I.E data that is modified otherwise dont print it.
-    for (int i = 0; i < bf_header.data_length; i++) {
-        word_type word = bof_read_word(bf_file);
-        memory.words[bf_header.data_start_address+i] = word;
-        vm->words_index[bf_header.data_start_address+i] = 1;
-    }
-    memory.words[bf_header.data_start_address + bf_header.data_length] = 0;
-    vm->words_index[bf_header.data_start_address + bf_header.data_length] = 1;
-
-    memory.words[vm->registers[1]] = 0;
-    vm->words_index[vm->registers[1]] = 1;
-}
-
-// Print the loaded program for listing (-p flag)
-void vm_print_program(VM *vm) {
-    printf("Address Instruction\n");
-
-    for (int i = 0; i < vm->program_size; i++) {
-        printf("%6d: %s\n", i, instruction_assembly_form(i, memory.instrs[i]));
-    }
-    int count = 0;
-    for (int i = vm->bf_header.data_start_address; i <= vm->bf_header.data_start_address + vm->bf_header.data_length; i++) {
-        if (count % 5 == 0 && count != 0) {
-            printf("\n");
-        }
-        printf("%8d: %d\t",  i, memory.words[i]);
-        count++;
-    }
-    if (count % 5 == 0 && count != 0) {
-        printf("\n%11s     \n", "...");
-    }
-    else if (count == 1) {
-        printf("%11s     \n", "...");
-    }
-    else {
-        printf("%11s     \n\n", "...");
-    }
-}
-
-void print_registers(VM *vm) {
-    printf("%8s: %d\t", "PC", vm->pc);
-    for (int i = 0; i < NUM_REGISTERS; i++ ) {
-        if (i % 5 == 0) {
-            printf("\n");
-        }
-        char buffer[100];
-        sprintf(buffer, "GPR[%-3s]", regname_get(i));
-        printf("%8s: %d\t", buffer, vm->registers[i]);
-    }
-    printf("\n"); 
-}
-
-void print_instruction(VM *vm, int instruction_number) {
-    printf("==>%7d: %s\n", instruction_number, instruction_assembly_form(1, memory.instrs[instruction_number]));
-}
-
-void print_words(VM *vm) {
-    int index;
-    int count = 0;
-    for (index = vm->program_size; index <= vm->bf_header.stack_bottom_addr; index++) {
-        if (vm->words_index[index] != 1) {
-            continue;
-        }
-        if (count % 5 == 0 && count != 0) {
-            printf("\n");
-        }
-        printf("%8d: %d\t",  index, memory.words[index]);
-        count++;
-    }
-    printf("\n");
-}
-
-
-// Simple Stack Machine execution with detailed debugging
-void vm_run(VM *vm, int instruction_number) {
-    bin_instr_t instr = memory.instrs[instruction_number];
-    instr_type opC = instruction_type(memory.instrs[instruction_number]);
-    if(opC == comp_instr_type)
-    {
-        int func = instr.comp.func;
-        switch (func){
-            case NOP_F:
-                //Literally does nothing.
-                vm->pc++;
-                break;
-            case ADD_F:
-                // OP 0/Func 1
-                memory.words[vm->registers[instr.comp.rt] + machine_types_formOffset(instr.comp.ot)] = memory.words[vm->registers[1]] + (memory.words[vm->registers[instr.comp.rs] + machine_types_formOffset(instr.comp.os)]);
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[instr.comp.rt] + machine_types_formOffset(instr.comp.ot)] = 1;
-                vm->words_index[vm->registers[instr.comp.rs] + machine_types_formOffset(instr.comp.os)] = 1;
-                vm->pc++;
-                break;
-            case SUB_F:
-                // OP 0/Func 2
-                memory.words[vm->registers[instr.comp.rt] + machine_types_formOffset(instr.comp.ot)] = memory.words[vm->registers[1]] - (memory.words[vm->registers[instr.comp.rs] + machine_types_formOffset(instr.comp.os)]);
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[instr.comp.rt] + machine_types_formOffset(instr.comp.ot)] = 1;
-                vm->words_index[vm->registers[instr.comp.rs] + machine_types_formOffset(instr.comp.os)] = 1;
-                vm->pc++;
-                break;
-            case CPW_F:
-                // OP 0/Func 3
-                memory.words[vm->registers[instr.comp.rt] + machine_types_formOffset(instr.comp.ot)] = memory.words[vm->registers[instr.comp.rs] + machine_types_formOffset(instr.comp.ot)];
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[instr.comp.rt] + machine_types_formOffset(instr.comp.ot)] = 1;
-                vm->words_index[vm->registers[instr.comp.rs] + machine_types_formOffset(instr.comp.ot)] = 1;
-                vm->pc++;
-                break;
-            case AND_F:
-                // OP 0/Func 5
-                memory.words[vm->registers[instr.comp.rt + machine_types_formOffset(instr.comp.ot)]] = memory.words[vm->registers[1]] & memory.words[vm->registers[instr.comp.rs + machine_types_formOffset(instr.comp.os)]];
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[instr.comp.rt + machine_types_formOffset(instr.comp.ot)]] = 1;
-                vm->words_index[vm->registers[instr.comp.rs + machine_types_formOffset(instr.comp.os)]] = 1;
-                vm->pc++;
-                break;
-            case BOR_F:
-                // OP 0/Func 6
-                memory.words[vm->registers[instr.comp.rt + machine_types_formOffset(instr.comp.ot)]] = memory.words[vm->registers[1]] | memory.words[vm->registers[instr.comp.rs + machine_types_formOffset(instr.comp.os)]];
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[instr.comp.rt + machine_types_formOffset(instr.comp.ot)]] = 1;
-                vm->words_index[vm->registers[instr.comp.rs + machine_types_formOffset(instr.comp.os)]] = 1;
-                vm->pc++;
-                break;
-            case NOR_F:
-                // OP 0/Func 7
-                memory.words[vm->registers[instr.comp.rt + machine_types_formOffset(instr.comp.ot)]] = ~(memory.words[vm->registers[1]] | memory.words[vm->registers[instr.comp.rs + machine_types_formOffset(instr.comp.os)]]);
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[instr.comp.rt + machine_types_formOffset(instr.comp.ot)]] = 1;
-                vm->words_index[vm->registers[instr.comp.rs + machine_types_formOffset(instr.comp.os)]] = 1;
-                vm->pc++;
-                break;
-            case XOR_F: 
-                // OP 0/Func 8
-                memory.words[vm->registers[instr.comp.rt + machine_types_formOffset(instr.comp.ot)]] = memory.words[vm->registers[1]] ^ memory.words[vm->registers[instr.comp.rs + machine_types_formOffset(instr.comp.os)]];
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[instr.comp.rt + machine_types_formOffset(instr.comp.ot)]] = 1;
-                vm->words_index[vm->registers[instr.comp.rs + machine_types_formOffset(instr.comp.os)]] = 1;
-                vm->pc++;
-                break;
-            case LWR_F:
-                // OP 0/Func 9
-                vm->registers[instr.comp.rt] = memory.words[vm->registers[instr.comp.rs] + machine_types_formOffset(instr.comp.os)];
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[instr.comp.rs] + machine_types_formOffset(instr.comp.os)] = 1;
-                vm->pc++;
-                break;
-            case SWR_F:
-                // OP 0/Func 10
-                memory.words[vm->registers[instr.comp.rt] + machine_types_formOffset(instr.comp.ot)] = vm->registers[instr.comp.rs];
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[instr.comp.rt] + machine_types_formOffset(instr.comp.ot)] = 1;
-                vm->pc++;
-                break;
-            case SCA_F:
-                // OP 0/Func 11
-                memory.words[vm->registers[instr.comp.rt] + machine_types_formOffset(instr.comp.ot)] = (vm->registers[instr.comp.rs] + machine_types_formOffset(instr.comp.os));
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[instr.comp.rt] + machine_types_formOffset(instr.comp.ot)] = 1;
-                vm->pc++;
-                break;
-            case LWI_F:
-                // OP 0/Func 12
-                memory.words[vm->registers[instr.comp.rt] + machine_types_formOffset(instr.comp.ot)] = memory.words[memory.words[vm->registers[instr.comp.rs] + machine_types_formOffset(instr.comp.rs)]];
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[instr.comp.rt] + machine_types_formOffset(instr.comp.ot)] = 1;
-                vm->words_index[memory.words[vm->registers[instr.comp.rs] + machine_types_formOffset(instr.comp.rs)]] = 1;
-                vm->pc++;
-                break;
-            case NEG_F:
-                // OP 0/Func 13
-                memory.words[vm->registers[instr.comp.rt] + machine_types_formOffset(instr.comp.ot)] = -memory.words[vm->registers[instr.comp.rs] + machine_types_formOffset(instr.comp.os)];
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[instr.comp.rt] + machine_types_formOffset(instr.comp.ot)] = 1;
-                vm->words_index[vm->registers[instr.comp.rs] + machine_types_formOffset(instr.comp.os)] = 1;
-                vm->pc++;
-                break;
-        }
-    }
-    if(opC == other_comp_instr_type){
-        int func = instr.comp.func;
-
-        switch(func){
-            case LIT_F:
-                // OP 1/Func 1
-                memory.words[vm->registers[instr.othc.reg] + machine_types_formOffset(instr.othc.offset)] = machine_types_sgnExt(instr.othc.arg);
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[instr.othc.reg] + machine_types_formOffset(instr.othc.offset)] = 1;
-                vm->pc++;
-                break;
-            case ARI_F:
-                // OP 1/Func 2
-                vm->registers[instr.othc.reg] = (vm->registers[instr.othc.reg] + machine_types_sgnExt(instr.othc.arg));
-                vm->pc++;
-                break;
-            case SRI_F:
-                // OP 1/Func 3
-                vm->registers[instr.othc.reg] = (vm->registers[instr.othc.reg] - machine_types_sgnExt(instr.othc.arg));
-                vm->pc++;
-                break;
-            case MUL_F:
-                // OP 1/Func 4
-                memory.words[vm->registers[instr.othc.reg] + machine_types_formOffset(instr.othc.offset)] = memory.words[vm->registers[1]] * (memory.words[vm->registers[instr.othc.reg] + machine_types_formOffset(instr.othc.offset)]);
-                vm->words_index[vm->registers[instr.othc.reg] + machine_types_formOffset(instr.othc.offset)] = 1;
-                vm->pc++;
-                break;
-            case DIV_F:
-                // OP 1/Func 5
-                vm->HI = memory.words[vm->registers[1]] % (memory.words[vm->registers[instr.othc.reg] + machine_types_formOffset(instr.othc.offset)]);
-                vm->LO = memory.words[vm->registers[1]] / (memory.words[vm->registers[instr.othc.reg] + machine_types_formOffset(instr.othc.offset)]);
-                vm->pc++;
-                break;
-            case CFHI_F:
-                // OP 1/Func 6
-                memory.words[memory.words[instr.othc.reg] + machine_types_formOffset(instr.othc.offset)] = vm->HI;
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[memory.words[instr.othc.reg] + machine_types_formOffset(instr.othc.offset)] = 1;
-                vm->pc++;
-                break;
-            case CFLO_F:
-                // OP 1/Func 7
-                memory.words[vm->registers[instr.othc.reg] + machine_types_formOffset(instr.othc.offset)] = vm->LO;
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[instr.othc.reg] + machine_types_formOffset(instr.othc.offset)] = 1;
-                vm->pc++;
-                break;
-            case SLL_F:
-                // OP 1/Func 8
-                memory.words[vm->registers[instr.othc.reg] + machine_types_formOffset(instr.othc.offset)] = memory.words[vm->registers[1]] << instr.othc.arg;
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[instr.othc.reg] + machine_types_formOffset(instr.othc.offset)] = 1;
-                vm->pc++;
-                break;
-            case SRL_F:
-                // OP 1/Func 9
-                memory.words[vm->registers[instr.othc.reg] + machine_types_formOffset(instr.othc.offset)] = memory.words[vm->registers[1]] >> instr.othc.arg;
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[instr.othc.reg] + machine_types_formOffset(instr.othc.offset)] = 1;
-                vm->pc++;
-                break;
-            case JMP_F:
-                // OP 1/Func 10
-                vm->pc = memory.words[vm->registers[instr.othc.reg] + machine_types_formOffset(instr.othc.offset)];
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[instr.othc.reg] + machine_types_formOffset(instr.othc.offset)] = 1;
-                break;
-            case CSI_F:
-                // OP 1/Func 11
-                vm->registers[7] = vm->pc;
-                vm->pc = memory.words[vm->registers[instr.othc.reg] + machine_types_formOffset(instr.othc.offset)];
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[instr.othc.reg] + machine_types_formOffset(instr.othc.offset)] = 1;
-                break;
-            case JREL_F:
-                // OP 1/Func 15
-                vm->pc = ((vm->pc - 1) + machine_types_formOffset(instr.othc.offset));
-                break;
-        }
-    }
-    if(opC == immed_instr_type){
-        immed_instr_t immed = instr.immed;
-        int op = immed.op;
-        switch(op){
-            case ADDI_O:
-                //OP 2
-                memory.words[vm->registers[immed.reg] + machine_types_formOffset(immed.offset)] += machine_types_sgnExt(immed.immed);
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[immed.reg] + machine_types_formOffset(immed.offset)] = 1;
-                vm->pc++;
-                break;
-            case ANDI_O:
-                //OP 3
-                memory.words[vm->registers[immed.reg] + machine_types_formOffset(immed.offset)] &= machine_types_zeroExt(immed.immed);
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[immed.reg] + machine_types_formOffset(immed.offset)] = 1;
-                vm->pc++;
-                break;
-            case BORI_O:
-                //OP 4
-                memory.words[vm->registers[immed.reg] + machine_types_formOffset(immed.offset)] |= machine_types_zeroExt(immed.immed);
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[immed.reg] + machine_types_formOffset(immed.offset)] = 1;
-                vm->pc++;
-                break;
-            case NORI_O:
-                //OP 5
-                memory.words[vm->registers[immed.reg] + machine_types_formOffset(immed.offset)] =  ~(machine_types_zeroExt(immed.immed) | (memory.words[vm->registers[immed.reg] + machine_types_formOffset(immed.offset)]));
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[immed.reg] + machine_types_formOffset(immed.offset)] = 1;
-                vm->pc++;
-                break;
-            case XORI_O:
-                //OP 6
-                memory.words[vm->registers[immed.reg] + machine_types_formOffset(immed.offset)] ^= machine_types_zeroExt(immed.immed);
-                //Code Below used to store the index that we want to print in the output.
-                vm->words_index[vm->registers[immed.reg] + machine_types_formOffset(immed.offset)] = 1;
-                vm->pc++;
-                break;
-            case BEQ_O:
-                if (memory.words[vm->registers[1]] == memory.words[vm->registers[immed.reg] + machine_types_formOffset(immed.offset)]) {
-                    vm->pc--;
-                    vm->pc += machine_types_formOffset(immed.immed);
-                }
-                else {
-                    vm->pc++;
-                }
-                break;
-            case BGEZ_O:
-                if (memory.words[vm->registers[immed.reg] + machine_types_formOffset(immed.offset)] >= 0) {
-                    vm->pc--;
-                    vm->pc += machine_types_formOffset(immed.immed); 
-                }
-                else {
-                    vm->pc++;
-                }
-                break;
-            case BGTZ_O:
-                if (memory.words[vm->registers[immed.reg] + machine_types_formOffset(immed.offset)] > 0) {
-                    vm->pc--;
-                    vm->pc += machine_types_formOffset(immed.immed); 
-                }
-                else {
-                    vm->pc++;
-                }
-                break;
-            case BLEZ_O:
-                if (memory.words[vm->registers[immed.reg] + machine_types_formOffset(immed.offset)] <= 0) {
-                    vm->pc--;
-                    vm->pc += machine_types_formOffset(immed.immed); 
-                }
-                else {
-                    vm->pc++;
-                }
-                break; 
-            case BLTZ_O:
-                if (memory.words[vm->registers[immed.reg] + machine_types_formOffset(immed.offset)] < 0) {
-                    vm->pc--;
-                    vm->pc += machine_types_formOffset(immed.immed); 
-                }
-                else {
-                    vm->pc++;
-                }
-                break;
-            case BNE_O:
-                if (memory.words[vm->registers[1]] != memory.words[vm->registers[immed.reg] + machine_types_formOffset(immed.offset)]) {
-                    vm->pc--;
-                    vm->pc += machine_types_formOffset(immed.immed);
-                }
-                else {
-                    vm->pc++;
-                }
-                break;
-        }
-    }
-    if (opC == jump_instr_type){
-        int binary = instr.jump.op;
-        switch(binary){
-            case JMPA_O:
-                //OP 13
-                vm->pc = machine_types_formAddress(vm->pc - 1, instr.jump.addr);
-                break;
-            case CALL_O:
-                //OP 14
-                vm->registers[7] = vm->pc;
-                vm->pc = machine_types_formAddress(vm->pc - 1, instr.jump.addr);
-                break; 
-            case RTN_O:
-                //OP 15
-                vm->pc = vm->registers[7];
-                break;
-        }
-    }
-    if (opC == syscall_instr_type) {
-        int code = instr.syscall.code;
-        int reg = instr.syscall.reg;
-        int offset = instr.syscall.offset;
-        //All of these Op's should be OP 1 FUNC 15.
-        switch(code){
-            case 1: 
-                printf("GFDJGDOFHGDFHGDFH");
-                print_instruction(vm, instruction_number);
-                exit(machine_types_sgnExt(offset));
-                vm->pc++;
-                break;
-
-            case 2: 
-                char* str = (char*)&memory.words[vm->registers[reg] + machine_types_formOffset(offset)];
-                memory.words[vm->registers[1]] = printf("%s", str);
-                vm->words_index[vm->registers[1]] = 1;
-                vm->pc++;
-                break;
-            case 3:
-                int integer = (int)memory.words[vm->registers[reg] + machine_types_formOffset(offset)];
-                memory.words[vm->registers[1]] = printf("%d", integer);
-                vm->words_index[vm->registers[1]] = 1;
-                vm->pc++;
-                break;
-
-            case 4: 
-                memory.words[vm->registers[1]] = fputc(memory.words[vm->registers[reg] + machine_types_formOffset(offset)], stdout);
-                vm->words_index[vm->registers[1]] = 1;
-                vm->pc++;
-                break;
-
-            case 5:
-                vm->registers[reg + machine_types_formOffset(offset)] = getc(stdin);
-                vm->pc++;
-                break;
-            case 2046:
-                vm->tracing = true;
-                vm->pc++;
-                break;
-            case 2047:
-                vm->tracing = false;
-                vm->pc++;
-                break;
-        }
-    }
-}
+#include "vm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include "../provided/bof.h"
+#include "../provided/machine_types.h"
+#include "../provided/regname.h"
+#include "../provided/instruction.h"
+#include "ngram.h"
+#include "profile.h"
+#include "callgraph.h"
+#include "memprof.h"
+#include "hostperf.h"
+#include "jit.h"
+#include "trace.h"
+#include "guest_io.h"
+#include "trace_bin.h"
+#include "sandbox.h"
+
+// Register columns of print_registers ("GPR[$gp]: "), built once by vm_init
+static char register_labels[NUM_REGISTERS][24];
+static pthread_once_t register_labels_once = PTHREAD_ONCE_INIT;
+
+static void build_register_labels(void) {
+    for (int i = 0; i < NUM_REGISTERS; i++) {
+        char buffer[16];
+        sprintf(buffer, "GPR[%-3s]", regname_get(i));
+        snprintf(register_labels[i], sizeof(register_labels[i]), "%8s: ", buffer);
+    }
+}
+
+// instruction_assembly_form formats into a static buffer, so VMs running
+// on different threads take turns with it
+static pthread_mutex_t assembly_form_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Default guest memory: a private anonymous mapping, which comes zeroed.
+// Nothing is committed up front; the kernel supplies each page when it is
+// first touched.
+static void *vm_mmap_alloc(size_t size, void *ctx) {
+    void *mem = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return mem == MAP_FAILED ? NULL : mem;
+}
+
+static void vm_mmap_release(void *mem, size_t size, void *ctx) {
+    munmap(mem, size);
+}
+
+static const vm_allocator vm_mmap_allocator = {vm_mmap_alloc, vm_mmap_release, NULL};
+
+// Initialize the VM with default values, its guest memory mapped with mmap
+void vm_init(VM *vm) {
+    vm_init_allocator(vm, NULL);
+}
+
+// Initialize the VM with default values, taking its guest memory from
+// allocator (or mmap, if allocator is NULL)
+void vm_init_allocator(VM *vm, const vm_allocator *allocator) {
+    vm->allocator = allocator ? *allocator : vm_mmap_allocator;
+    vm->memory = NULL;
+    vm_set_memory_words(vm, VM_MAX_WORDS);
+    vm->program_size = 0;  // No program loaded initially
+    vm->pc = 0;
+    vm->HI = 0;
+    vm->LO = 0;
+    vm->tracing = true;
+    vm->code = NULL;
+    vm->threaded_code = NULL;
+    vm->blocks = NULL;
+    vm->text_writes = 0;
+    vm->ngrams = NULL;
+    vm->profile = NULL;
+    vm->callgraph = NULL;
+    vm->memprof = NULL;
+    vm->host_counters = NULL;
+    vm->jit = NULL;
+    vm->jit_threshold = JIT_THRESHOLD;
+    vm->engine = SWITCH_ENGINE;
+    vm->sandbox = false;
+    vm->frame = NULL;
+    vm->retired = 0;
+    vm->fault_steps = 0;
+    vm->state = VM_RUNNING;
+    vm->exit_code = 0;
+    vm->fault_pc = 0;
+    vm->fault_msg = NULL;
+    for (int i = 0; i < NUM_REGISTERS; i++) {
+        vm->registers[i] = 0; 
+    }
+    pthread_once(&register_labels_once, build_register_labels);
+    vm->trace = trace_create(stdout);
+    vm->trace_bin = NULL;
+    vm->in = guest_input_create(stdin);
+    //Large enough that calloc maps it, so untouched parts cost nothing.
+    vm->dirty_pages = calloc(VM_NUM_PAGES, 1);
+    if (!vm->dirty_pages) {
+        perror("Error allocating dirty-page table");
+        exit(EXIT_FAILURE);
+    }
+    memset(vm->dirty_dirs, 0, sizeof(vm->dirty_dirs));
+    vm->asm_text = NULL;
+    memset(vm->touched_bits, 0, sizeof(vm->touched_bits));
+    vm->touched = NULL;
+    vm->num_touched = 0;
+    vm->touched_capacity = 0;
+}
+
+// Give the VM words words of guest memory (rounded up to whole pages) in
+// place of its current memory. Call before vm_load_program; the old
+// contents are dropped.
+void vm_set_memory_words(VM *vm, uint32_t words) {
+    if (words == 0 || words > VM_MAX_WORDS) {
+        fprintf(stderr, "Guest memory must be 1 to %u words\n", VM_MAX_WORDS);
+        exit(EXIT_FAILURE);
+    }
+    if (vm->memory) {
+        vm->allocator.release(vm->memory, (size_t) vm->memory_words * sizeof(word_type), vm->allocator.ctx);
+    }
+    vm->memory_words = (words + VM_PAGE_WORDS - 1) / VM_PAGE_WORDS * VM_PAGE_WORDS;
+    vm->memory = vm->allocator.alloc((size_t) vm->memory_words * sizeof(word_type), vm->allocator.ctx);
+    if (!vm->memory) {
+        perror("Error allocating guest memory");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void vm_flush_blocks(VM *vm);
+
+// Release the guest memory, the predecoded text built by vm_load_program, and the engines' state
+void vm_free(VM *vm) {
+    vm_flush_blocks(vm);
+    free(vm->blocks);
+    vm->blocks = NULL;
+    free(vm->code);
+    vm->code = NULL;
+    free(vm->threaded_code);
+    vm->threaded_code = NULL;
+    if (vm->asm_text) {
+        for (int i = 0; i < vm->program_size; i++) {
+            free(vm->asm_text[i]);
+        }
+    }
+    free(vm->asm_text);
+    vm->asm_text = NULL;
+    trace_destroy(vm->trace);
+    vm->trace = NULL;
+    guest_input_destroy(vm->in);
+    vm->in = NULL;
+    free(vm->touched);
+    vm->touched = NULL;
+    vm->num_touched = 0;
+    vm->touched_capacity = 0;
+    for (int i = 0; i < VM_NUM_DIRS; i++) {
+        free(vm->touched_bits[i]);
+        vm->touched_bits[i] = NULL;
+    }
+    free(vm->dirty_pages);
+    vm->dirty_pages = NULL;
+#ifdef VM_JIT
+    jit_destroy(vm->jit);
+    vm->jit = NULL;
+#endif
+    if (vm->memory) {
+        vm->allocator.release(vm->memory, (size_t) vm->memory_words * sizeof(word_type), vm->allocator.ctx);
+        vm->memory = NULL;
+    }
+}
+
+// Check a BOF's header against the file's size and a guest memory of
+// memory_words words: the sections must be in the file and fit in memory.
+// Returns false, with a message in error, if they don't.
+bool vm_check_program(const BOFHeader *header, uint64_t file_bytes, uint32_t memory_words,
+                      const char *filename, char *error, size_t error_len) {
+    if (!bof_has_correct_magic_number(*header)
+        || header->text_length < 0 || header->data_length < 0
+        || header->text_start_address < 0 || header->data_start_address < 0
+        || header->stack_bottom_addr < 0
+        || file_bytes < sizeof(*header)
+                + (uint64_t) header->text_length * sizeof(bin_instr_t)
+                + (uint64_t) header->data_length * sizeof(word_type)) {
+        snprintf(error, error_len, "%s is not a well-formed BOF file (bad magic number, or truncated)", filename);
+        return false;
+    }
+    if ((uint32_t) header->text_length > memory_words
+        || (uint64_t) header->data_start_address + header->data_length >= memory_words
+        || (uint32_t) header->stack_bottom_addr >= memory_words) {
+        snprintf(error, error_len, "%s does not fit in %u words of guest memory", filename, memory_words);
+        return false;
+    }
+    return true;
+}
+
+// Load the program (instructions) into the VM with debugging.
+// Returns false, with a message in error, if the file can't be read, isn't
+// a well-formed BOF, or doesn't fit in the VM's guest memory.
+bool vm_read_program(VM *vm, const char *filename, char *error, size_t error_len) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        snprintf(error, error_len, "Error opening file %s: %s", filename, strerror(errno));
+        return false;
+    }
+
+    //Check the header and the file's size before touching guest memory
+    BOFHeader bf_header;
+    struct stat st;
+    if (fread(&bf_header, sizeof(bf_header), 1, file) != 1 || fstat(fileno(file), &st) != 0) {
+        snprintf(error, error_len, "Cannot read header from %s", filename);
+        fclose(file);
+        return false;
+    }
+    if (!vm_check_program(&bf_header, (uint64_t) st.st_size, vm->memory_words, filename, error, error_len)) {
+        fclose(file);
+        return false;
+    }
+
+    // Read the instructions into guest memory
+    vm->bf_header = bf_header;
+
+    vm->pc = bf_header.text_start_address;
+    vm->registers[0] = bf_header.data_start_address;
+    vm->registers[1] = bf_header.stack_bottom_addr;
+    vm->registers[2] = bf_header.stack_bottom_addr;
+
+    vm->program_size = bf_header.text_length;
+
+    //Pages the loader writes are marked dirty, so a snapshot knows to save them.
+    if (fread(vm->memory->instrs, sizeof(bin_instr_t), vm->program_size, file) != (size_t) vm->program_size) {
+        snprintf(error, error_len, "Cannot read instructions from %s", filename);
+        fclose(file);
+        return false;
+    }
+    for (int i = 0; i < vm->program_size; i++) {
+        VM_MARK_DIRTY(vm, i);
+    }
+    //System used to track which data values we want to use in the output, I.E data that is modified otherwise dont print it.
+    word_type *data = &vm->memory->words[bf_header.data_start_address];
+    if (fread(data, sizeof(word_type), bf_header.data_length, file) != (size_t) bf_header.data_length) {
+        snprintf(error, error_len, "Cannot read data from %s", filename);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+    for (int i = 0; i < bf_header.data_length; i++) {
+        VM_MARK_DIRTY(vm, bf_header.data_start_address + i);
+        vm_touch(vm, bf_header.data_start_address + i);
+    }
+    vm->memory->words[bf_header.data_start_address + bf_header.data_length] = 0;
+    vm_touch(vm, bf_header.data_start_address + bf_header.data_length);
+
+    vm->memory->words[vm->registers[1]] = 0;
+    vm_touch(vm, vm->registers[1]);
+    vm_decode_text(vm);
+    return true;
+}
+
+// vm_read_program for the command-line tools: exits on any error
+void vm_load_program(VM *vm, const char *filename) {
+    char error[512];
+    if (!vm_read_program(vm, filename, error, sizeof(error))) {
+        fprintf(stderr, "%s\n", error);
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Decode the text section (vm->program_size words of guest memory) once,
+// so vm_run never has to look at the bitfields again
+void vm_decode_text(VM *vm) {
+    size_t code_bytes = vm->program_size * sizeof(decoded_instr_t);
+    code_bytes = (code_bytes + CODE_ALIGNMENT - 1) / CODE_ALIGNMENT * CODE_ALIGNMENT;
+    vm->code = aligned_alloc(CODE_ALIGNMENT, code_bytes > 0 ? code_bytes : CODE_ALIGNMENT);
+    if (!vm->code) {
+        perror("Error allocating decoded program");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < vm->program_size; i++) {
+        vm_decode(vm->memory->instrs[i], i, &vm->code[i]);
+    }
+    vm_fuse(vm);
+    vm->asm_text = calloc(vm->program_size > 0 ? vm->program_size : 1, sizeof(char *));
+    if (!vm->asm_text) {
+        perror("Error allocating assembly text cache");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Decode the binary instruction found at address addr into d.
+// Operands are laid out the same way for every format: the register and
+// offset naming the word written go in rt/ot, the ones naming the word
+// read go in rs/os (or rt/ot when the format only has one pair).
+void vm_decode(bin_instr_t instr, address_type addr, decoded_instr_t *d) {
+    d->handler = ILLEGAL_H;
+    d->rt = 0;
+    d->rs = 0;
+    d->ot = 0;
+    d->os = 0;
+    d->imm = 0;
+    d->target = 0;
+
+    switch (instruction_type(instr)) {
+        case comp_instr_type:
+            d->rt = instr.comp.rt;
+            d->ot = machine_types_formOffset(instr.comp.ot);
+            d->rs = instr.comp.rs;
+            d->os = machine_types_formOffset(instr.comp.os);
+            switch (instr.comp.func) {
+                case NOP_F: d->handler = NOP_H; break;
+                case ADD_F: d->handler = ADD_H; break;
+                case SUB_F: d->handler = SUB_H; break;
+                case CPW_F: d->handler = CPW_H; break;
+                case AND_F: d->handler = AND_H; break;
+                case BOR_F: d->handler = BOR_H; break;
+                case NOR_F: d->handler = NOR_H; break;
+                case XOR_F: d->handler = XOR_H; break;
+                case LWR_F: d->handler = LWR_H; break;
+                case SWR_F: d->handler = SWR_H; break;
+                case SCA_F: d->handler = SCA_H; break;
+                case LWI_F: d->handler = LWI_H; break;
+                case NEG_F: d->handler = NEG_H; break;
+            }
+            break;
+        case other_comp_instr_type:
+            d->rt = instr.othc.reg;
+            d->ot = machine_types_formOffset(instr.othc.offset);
+            d->imm = machine_types_sgnExt(instr.othc.arg);
+            switch (instr.othc.func) {
+                case LIT_F: d->handler = LIT_H; break;
+                case ARI_F: d->handler = ARI_H; break;
+                case SRI_F: d->handler = SRI_H; break;
+                case MUL_F: d->handler = MUL_H; break;
+                case DIV_F: d->handler = DIV_H; break;
+                case CFHI_F: d->handler = CFHI_H; break;
+                case CFLO_F: d->handler = CFLO_H; break;
+                //Shift counts are taken mod 32, as x86 (and so the JIT) takes
+                //them; C leaves a shift by 32 or more undefined.
+                case SLL_F:
+                    d->handler = SLL_H;
+                    d->imm = instr.othc.arg & (WORD_IN_BITS - 1);
+                    break;
+                case SRL_F:
+                    d->handler = SRL_H;
+                    d->imm = instr.othc.arg & (WORD_IN_BITS - 1);
+                    break;
+                case JMP_F: d->handler = JMP_H; break;
+                case CSI_F: d->handler = CSI_H; break;
+                case JREL_F:
+                    d->handler = JREL_H;
+                    d->target = addr + d->ot;
+                    break;
+            }
+            break;
+        case immed_instr_type:
+            d->rt = instr.immed.reg;
+            d->ot = machine_types_formOffset(instr.immed.offset);
+            switch (instr.immed.op) {
+                case ADDI_O:
+                    d->handler = ADDI_H;
+                    d->imm = machine_types_sgnExt(instr.immed.immed);
+                    break;
+                case ANDI_O: d->handler = ANDI_H; d->imm = machine_types_zeroExt(instr.uimmed.uimmed); break;
+                case BORI_O: d->handler = BORI_H; d->imm = machine_types_zeroExt(instr.uimmed.uimmed); break;
+                case NORI_O: d->handler = NORI_H; d->imm = machine_types_zeroExt(instr.uimmed.uimmed); break;
+                case XORI_O: d->handler = XORI_H; d->imm = machine_types_zeroExt(instr.uimmed.uimmed); break;
+                case BEQ_O: d->handler = BEQ_H; break;
+                case BGEZ_O: d->handler = BGEZ_H; break;
+                case BGTZ_O: d->handler = BGTZ_H; break;
+                case BLEZ_O: d->handler = BLEZ_H; break;
+                case BLTZ_O: d->handler = BLTZ_H; break;
+                case BNE_O: d->handler = BNE_H; break;
+            }
+            if (d->handler >= BEQ_H && d->handler <= BNE_H) {
+                d->target = addr + machine_types_formOffset(instr.immed.immed);
+            }
+            break;
+        case jump_instr_type:
+            switch (instr.jump.op) {
+                case JMPA_O: d->handler = JMPA_H; break;
+                case CALL_O: d->handler = CALL_H; break;
+                case RTN_O: d->handler = RTN_H; break;
+            }
+            d->target = machine_types_formAddress(addr, instr.jump.addr);
+            break;
+        case syscall_instr_type:
+            d->rt = instr.syscall.reg;
+            d->ot = machine_types_formOffset(instr.syscall.offset);
+            switch ((unsigned int) instr.syscall.code) {
+                case exit_sc:
+                    d->handler = EXIT_H;
+                    d->imm = machine_types_sgnExt(instr.syscall.offset);
+                    break;
+                case print_str_sc: d->handler = PSTR_H; break;
+                case print_int_sc: d->handler = PINT_H; break;
+                case print_char_sc: d->handler = PCH_H; break;
+                case read_char_sc: d->handler = RCH_H; break;
+                case start_tracing_sc: d->handler = STRA_H; break;
+                case stop_tracing_sc: d->handler = NOTR_H; break;
+            }
+            break;
+        case error_instr_type:
+            break;
+    }
+    d->fused = d->handler;
+}
+
+// Pairs of adjacent instructions that vm_fuse turns into superinstructions.
+// These are the hottest fall-through bigrams in -n profiles of compiled SSM code.
+static const struct {
+    uint8_t first;
+    uint8_t second;
+    uint8_t fused;
+} fusions[] = {
+    {SRI_H, LIT_H, SRI_LIT_H},  // push a literal
+    {SRI_H, CPW_H, SRI_CPW_H},  // push a copy of a word
+    {SRI_H, SWR_H, SRI_SWR_H},  // push a register
+    {LIT_H, BEQ_H, LIT_BEQ_H},  // compare with a literal and branch
+    {LIT_H, BNE_H, LIT_BNE_H},
+    {CPW_H, ADD_H, CPW_ADD_H},  // load a stack slot and add or subtract
+    {CPW_H, SUB_H, CPW_SUB_H},
+};
+
+// Set the fused handler of the instruction at text address i
+static void vm_fuse_at(VM *vm, int i) {
+    if (i < 0 || i >= vm->program_size) {
+        return;
+    }
+    decoded_instr_t *d = &vm->code[i];
+    d->fused = d->handler;
+    if (i + 1 == vm->program_size) {
+        return;
+    }
+    for (size_t f = 0; f < sizeof(fusions) / sizeof(fusions[0]); f++) {
+        if (d->handler == fusions[f].first && vm->code[i + 1].handler == fusions[f].second) {
+            d->fused = fusions[f].fused;
+            return;
+        }
+    }
+}
+
+// Mark the start of every fusable pair in the predecoded text.
+// Only the fused field changes, so each instruction still runs on its
+// own when it is a branch target or when vm_run single-steps it.
+void vm_fuse(VM *vm) {
+    for (int i = 0; i < vm->program_size; i++) {
+        vm_fuse_at(vm, i);
+    }
+    //The threaded code has to be rebuilt to pick up the new handlers.
+    free(vm->threaded_code);
+    vm->threaded_code = NULL;
+}
+
+// Return the name of h, as used in profiles (e.g., "ADD_H")
+const char *vm_handler_name(handler_type h) {
+#define HANDLER_NAME(h) #h,
+    static const char *const names[NUM_HANDLERS] = {
+        HANDLER_LIST(HANDLER_NAME)
+    };
+#undef HANDLER_NAME
+    return h < NUM_HANDLERS ? names[h] : "?";
+}
+
+// Print the loaded program for listing (-p flag)
+void vm_print_program(VM *vm) {
+    printf("Address Instruction\n");
+
+    for (int i = 0; i < vm->program_size; i++) {
+        printf("%6d: %s\n", i, instruction_assembly_form(i, vm->memory->instrs[i]));
+    }
+    int count = 0;
+    for (int i = vm->bf_header.data_start_address; i <= vm->bf_header.data_start_address + vm->bf_header.data_length; i++) {
+        if (count % 5 == 0 && count != 0) {
+            printf("\n");
+        }
+        printf("%8d: %d\t",  i, vm->memory->words[i]);
+        count++;
+    }
+    if (count % 5 == 0 && count != 0) {
+        printf("\n%11s     \n", "...");
+    }
+    else if (count == 1) {
+        printf("%11s     \n", "...");
+    }
+    else {
+        printf("%11s     \n\n", "...");
+    }
+}
+
+void print_registers(VM *vm) {
+    trace_buffer *tb = vm->trace;
+    trace_str(tb, "      PC: ");
+    trace_int(tb, vm->pc, 0);
+    trace_char(tb, '\t');
+    for (int i = 0; i < NUM_REGISTERS; i++ ) {
+        if (i % 5 == 0) {
+            trace_char(tb, '\n');
+        }
+        trace_str(tb, register_labels[i]);
+        trace_int(tb, vm->registers[i], 0);
+        trace_char(tb, '\t');
+    }
+    trace_char(tb, '\n');
+}
+
+// Return the assembly form of the instruction at text address addr.
+// Text words are only formatted again after a store changes them.
+const char *vm_instruction_text(VM *vm, int32_t addr) {
+    char **text = &vm->asm_text[addr];
+    if (!*text) {
+        bin_instr_t instr = vm->memory->instrs[addr];
+        pthread_mutex_lock(&assembly_form_lock);
+        *text = strdup(instruction_assembly_form(1, instr));
+        pthread_mutex_unlock(&assembly_form_lock);
+        if (!*text) {
+            perror("Error allocating assembly text");
+            exit(EXIT_FAILURE);
+        }
+    }
+    return *text;
+}
+
+void print_instruction(VM *vm, int instruction_number) {
+    trace_buffer *tb = vm->trace;
+    trace_str(tb, "==>");
+    trace_int(tb, instruction_number, 7);
+    trace_str(tb, ": ");
+    if (instruction_number >= 0 && instruction_number < vm->program_size) {
+        trace_str(tb, vm_instruction_text(vm, instruction_number));
+    } else {
+        //Read the word before taking the lock: outside the text it may be
+        //outside guest memory, and a sandbox fault must not leave it held.
+        bin_instr_t instr = vm->memory->instrs[instruction_number];
+        pthread_mutex_lock(&assembly_form_lock);
+        trace_str(tb, instruction_assembly_form(1, instr));
+        pthread_mutex_unlock(&assembly_form_lock);
+    }
+    trace_char(tb, '\n');
+}
+
+void print_words(VM *vm) {
+    trace_buffer *tb = vm->trace;
+    int count = 0;
+    //Find the first touched word past the text, then walk the sorted list.
+    int lo = 0, hi = vm->num_touched;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (vm->touched[mid] < vm->program_size) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    for (int i = lo; i < vm->num_touched; i++) {
+        int index = vm->touched[i];
+        if (index > vm->bf_header.stack_bottom_addr) {
+            break;
+        }
+        if (count % 5 == 0 && count != 0) {
+            trace_char(tb, '\n');
+        }
+        trace_int(tb, index, 8);
+        trace_str(tb, ": ");
+        trace_int(tb, vm->memory->words[index], 0);
+        trace_char(tb, '\t');
+        count++;
+    }
+    trace_char(tb, '\n');
+}
+
+// Record that the word at addr was read or written, so print_words lists it.
+// The bitmap makes repeat touches cheap; a new word is inserted into the
+// sorted list, so printing costs only as much as the words touched.
+// Bitmap leaves are allocated per directory entry on first touch.
+void vm_touch(VM *vm, int32_t addr) {
+    if ((uint32_t) addr >= vm->memory_words) {
+        return;
+    }
+    uint64_t **leaf = &vm->touched_bits[addr >> VM_DIR_SHIFT];
+    if (!*leaf) {
+        *leaf = calloc(VM_DIR_WORDS / 64, sizeof(uint64_t));
+        if (!*leaf) {
+            perror("Error allocating touched word bitmap");
+            exit(EXIT_FAILURE);
+        }
+    }
+    uint64_t *bits = &(*leaf)[(addr & (VM_DIR_WORDS - 1)) / 64];
+    uint64_t bit = 1ULL << (addr % 64);
+    if (*bits & bit) {
+        return;
+    }
+    *bits |= bit;
+
+    if (vm->num_touched == vm->touched_capacity) {
+        vm->touched_capacity = vm->touched_capacity ? vm->touched_capacity * 2 : 64;
+        vm->touched = realloc(vm->touched, vm->touched_capacity * sizeof(int32_t));
+        if (!vm->touched) {
+            perror("Error allocating touched word list");
+            exit(EXIT_FAILURE);
+        }
+    }
+    int i = vm->num_touched;
+    while (i > 0 && vm->touched[i - 1] > addr) {
+        vm->touched[i] = vm->touched[i - 1];
+        i--;
+    }
+    vm->touched[i] = addr;
+    vm->num_touched++;
+    if (vm->trace_bin) {
+        trace_bin_word(vm->trace_bin, addr);
+    }
+}
+
+// Send the VM's trace and guest output to out instead of stdout
+void vm_set_output(VM *vm, FILE *out) {
+    trace_flush(vm->trace);
+    vm->trace->out = out;
+}
+
+// Make RCH read from in instead of stdin
+void vm_set_input(VM *vm, FILE *in) {
+    guest_input_set(vm->in, in);
+}
+
+// Return the word at addr
+word_type vm_get_word(VM *vm, int32_t addr) {
+    return vm->memory->words[addr];
+}
+
+// Store value at addr, keeping the decoded text in step
+void vm_set_word(VM *vm, int32_t addr, word_type value) {
+    vm->memory->words[addr] = value;
+    VM_MARK_DIRTY(vm, addr);
+    if (addr >= 0 && addr < vm->program_size) {
+        vm_text_written(vm, addr);
+    }
+}
+
+
+
+// Longest straight-line block the block cache builds
+#define MAX_BLOCK_LENGTH 64
+
+// A cached basic block: the decoded instructions from start up to and
+// including the first one that can change the PC or stop the machine.
+struct block {
+    int32_t start;
+    int32_t length;
+#ifdef VM_JIT
+    uint32_t entries;           // times the engine has entered this block
+    jit_fn native;              // compiled code, or NULL
+    bool no_native;             // the JIT could not compile this block
+#endif
+    decoded_instr_t code[];
+};
+
+// Can the instruction run by handler h send control anywhere but the next word?
+static bool ends_block(uint8_t h) {
+    switch (h) {
+        case JMP_H: case CSI_H: case JREL_H:
+        case BEQ_H: case BGEZ_H: case BGTZ_H: case BLEZ_H: case BLTZ_H: case BNE_H:
+        case JMPA_H: case CALL_H: case RTN_H:
+        case EXIT_H: case PSTR_H: case PINT_H: case PCH_H: case RCH_H:
+        case STRA_H: case NOTR_H: case ILLEGAL_H:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Return the cached block entered at text address pc, building it if needed
+static struct block *vm_block_at(VM *vm, int32_t pc) {
+    struct block *b = vm->blocks[pc];
+    if (b) {
+        return b;
+    }
+    int length = 0;
+    while (pc + length < vm->program_size && length < MAX_BLOCK_LENGTH) {
+        length++;
+        if (ends_block(vm->code[pc + length - 1].handler)) {
+            break;
+        }
+    }
+    b = malloc(sizeof(struct block) + length * sizeof(decoded_instr_t));
+    if (!b) {
+        perror("Error allocating block");
+        exit(EXIT_FAILURE);
+    }
+    b->start = pc;
+    b->length = length;
+#ifdef VM_JIT
+    b->entries = 0;
+    b->native = NULL;
+    b->no_native = false;
+#endif
+    memcpy(b->code, &vm->code[pc], length * sizeof(decoded_instr_t));
+    vm->blocks[pc] = b;
+    return b;
+}
+
+// Free every cached block
+static void vm_flush_blocks(VM *vm) {
+    if (!vm->blocks) {
+        return;
+    }
+    for (int i = 0; i < vm->program_size; i++) {
+        free(vm->blocks[i]);
+        vm->blocks[i] = NULL;
+    }
+}
+
+// Keep the decoded forms of the text in step with a store to text address addr.
+// The word is decoded again, its fusions are redone, the threaded code and
+// the word's cached assembly text are dropped, and any cached block holding
+// it is freed.
+void vm_text_written(VM *vm, int32_t addr) {
+    vm_decode(vm->memory->instrs[addr], addr, &vm->code[addr]);
+    free(vm->asm_text[addr]);
+    vm->asm_text[addr] = NULL;
+    vm_fuse_at(vm, addr - 1);
+    vm_fuse_at(vm, addr);
+    free(vm->threaded_code);
+    vm->threaded_code = NULL;
+    vm->text_writes++;
+
+    if (!vm->blocks) {
+        return;
+    }
+    int first = addr - MAX_BLOCK_LENGTH + 1 > 0 ? addr - MAX_BLOCK_LENGTH + 1 : 0;
+    for (int i = first; i <= addr; i++) {
+        struct block *b = vm->blocks[i];
+        if (b && b->start + b->length > addr) {
+            free(b);
+            vm->blocks[i] = NULL;
+        }
+    }
+}
+
+// Return the decoded instruction at addr, decoding it into *slow if it
+// is outside the text section
+static const decoded_instr_t *vm_decoded_at(VM *vm, int32_t addr, decoded_instr_t *slow) {
+    if (addr >= 0 && addr < vm->program_size) {
+        return &vm->code[addr];
+    }
+    vm_decode(vm->memory->instrs[addr], addr, slow);
+    return slow;
+}
+
+// Return the handler of the instruction at addr
+static handler_type vm_handler_at(VM *vm, int32_t addr) {
+    decoded_instr_t slow;
+    return vm_decoded_at(vm, addr, &slow)->handler;
+}
+
+// Stop the machine because the instruction at pc cannot be executed
+void vm_fault(VM *vm, int32_t pc, const char *msg) {
+    vm->state = VM_FAULTED;
+    vm->fault_pc = pc;
+    vm->fault_msg = msg;
+}
+
+// Guest output (PSTR, PINT, PCH) goes into the trace buffer after the
+// trace so far, and into the binary trace if there is one. Each returns
+// the number of bytes written.
+
+// Write the string at addr, which ends at a NUL or the end of guest memory
+static size_t vm_guest_str(VM *vm, int32_t addr) {
+    const char *str = (const char *) &vm->memory->words[addr];
+    size_t max = (uint32_t) addr < vm->memory_words
+                 ? ((size_t) vm->memory_words - (uint32_t) addr) * sizeof(word_type) : SIZE_MAX;
+    size_t len = guest_write_str(vm->trace, str, max);
+    if (vm->trace_bin) {
+        trace_bin_output(vm->trace_bin, str, len);
+    }
+    return len;
+}
+
+// Write value in decimal
+static int vm_guest_int(VM *vm, int32_t value) {
+    int len = trace_int(vm->trace, value, 0);
+    if (vm->trace_bin) {
+        trace_bin_output(vm->trace_bin, vm->trace->buf + vm->trace->len - len, len);
+    }
+    return len;
+}
+
+static void vm_guest_char(VM *vm, char c) {
+    trace_char(vm->trace, c);
+    if (vm->trace_bin) {
+        trace_bin_output(vm->trace_bin, &c, 1);
+    }
+}
+
+// The number of the instruction running now, counting from 1 at the
+// program's first, from the engines' frames (as the sandbox counts them)
+uint64_t vm_current_step(VM *vm) {
+    uint64_t step = vm->retired;
+    for (vm_frame *f = vm->frame; f; f = f->outer) {
+        step += *f->steps;
+        if (f != vm->frame) {
+            continue;
+        }
+        if (!f->addr) {
+            step++;
+        } else if (f->first) {
+            step += *f->addr - *f->first + 1;
+        }
+    }
+    return step;
+}
+
+// Read the input byte RCH stores while its input is logged; returns
+// false if a replayed log has no read here
+static bool vm_guest_logged(VM *vm, int32_t *value) {
+    int c;
+    if (!guest_input_logged(vm->in, vm_current_step(vm), &c)) {
+        return false;
+    }
+    *value = c;
+    return true;
+}
+
+// Effective addresses of the word an instruction writes (rt/ot) and reads (rs/os)
+#define TARGET_ADDR(vm, d) ((vm)->registers[(d)->rt] + (d)->ot)
+#define SOURCE_ADDR(vm, d) ((vm)->registers[(d)->rs] + (d)->os)
+// The word on top of the stack
+#define STACK_TOP(vm) vm->memory->words[(vm)->registers[SP]]
+// Guest arithmetic wraps on overflow, as in two's complement (and as
+// bof2c_rt.h's helpers do); signed int32_t arithmetic in C would be undefined
+#define WRAP_ADD(a, b) ((int32_t) ((uint32_t) (a) + (uint32_t) (b)))
+#define WRAP_SUB(a, b) ((int32_t) ((uint32_t) (a) - (uint32_t) (b)))
+
+// Find the word the instruction at vm->pc will store to, before it runs.
+// Returns false if it stores to none (for the write log of vm --debug).
+bool vm_store_target(VM *vm, int32_t *addr) {
+    decoded_instr_t slow;
+    const decoded_instr_t *d = vm_decoded_at(vm, vm->pc, &slow);
+    switch (d->handler) {
+    case ADD_H: case SUB_H: case AND_H: case BOR_H: case NOR_H: case XOR_H:
+    case CPW_H: case NEG_H: case SWR_H: case SCA_H: case LWI_H: case LIT_H:
+    case CFHI_H: case CFLO_H: case SLL_H: case SRL_H: case RCH_H:
+    case ADDI_H: case ANDI_H: case BORI_H: case NORI_H: case XORI_H:
+        *addr = TARGET_ADDR(vm, d);
+        return true;
+    case PSTR_H: case PINT_H: case PCH_H:
+        *addr = vm->registers[SP];
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Simple Stack Machine execution with detailed debugging: runs one
+// instruction, recording the words it touches for print_words
+void vm_run(VM *vm, int instruction_number) {
+    decoded_instr_t slow;
+    const decoded_instr_t *d;
+    volatile uint32_t addr = instruction_number;
+    volatile uint64_t started = 1;
+    vm_frame frame = {&addr, &started, NULL, vm->frame};
+    vm->frame = &frame;
+    if (instruction_number >= 0 && instruction_number < vm->program_size) {
+        d = &vm->code[instruction_number];
+    } else {
+        //Jumps outside the text section still work, they just get decoded on the spot.
+        vm_decode(vm->memory->instrs[instruction_number], instruction_number, &slow);
+        d = &slow;
+    }
+    // As in the SSM, the PC is advanced before the instruction executes.
+    vm->pc = instruction_number + 1;
+    int32_t t, s;
+
+#define OP(h) case h:
+#define NEXT break
+#define PC (vm->pc)
+#define INSTR_ADDR instruction_number
+#define TRACING_CHANGED()
+#define HALT()
+#define STORED(a) do { \
+        VM_MARK_DIRTY(vm, a); \
+        if ((uint32_t) (a) < (uint32_t) vm->program_size) vm_text_written(vm, a); \
+        if (vm->trace_bin) trace_bin_word(vm->trace_bin, a); \
+    } while (0)
+#define TOUCHED(a) vm_touch(vm, a)
+    switch (d->handler) {
+#include "vm_ops.inc"
+    }
+    vm->frame = frame.outer;
+#undef OP
+#undef NEXT
+#undef PC
+#undef INSTR_ADDR
+#undef TRACING_CHANGED
+#undef HALT
+#undef STORED
+#undef TOUCHED
+}
+
+// Untraced variant of vm_run, generated from the same handler bodies but
+// without the touched-word bookkeeping, which only matters to print_words.
+// Steps until STRA turns tracing on, EXIT or a fault stops the machine,
+// or max_steps instructions have run, and returns the number executed.
+// Words touched while tracing is off are not listed once it is back on.
+uint64_t vm_run_untraced(VM *vm, uint64_t max_steps) {
+    decoded_instr_t slow;
+    const decoded_instr_t *d;
+    uint32_t pc = vm->pc;
+    volatile uint32_t addr = pc;
+    volatile uint64_t steps = 0;
+    int32_t t, s;
+    vm_frame frame = {&addr, &steps, NULL, vm->frame};
+    vm->frame = &frame;
+
+#define OP(h) case h:
+#define NEXT break
+#define PC pc
+#define INSTR_ADDR addr
+#define TRACING_CHANGED() goto done
+#define HALT() goto done
+#define STORED(a) do { \
+        VM_MARK_DIRTY(vm, a); \
+        if ((uint32_t) (a) < (uint32_t) vm->program_size) vm_text_written(vm, a); \
+    } while (0)
+#define TOUCHED(a)
+    while (steps < max_steps) {
+        addr = pc;
+        steps++;
+        if (addr < (uint32_t) vm->program_size) {
+            d = &vm->code[addr];
+        } else {
+            vm_decode(vm->memory->instrs[addr], addr, &slow);
+            d = &slow;
+        }
+        pc = addr + 1;
+        switch (d->handler) {
+#include "vm_ops.inc"
+        }
+    }
+done:
+    vm->pc = pc;
+    vm->frame = frame.outer;
+    return steps;
+#undef OP
+#undef NEXT
+#undef PC
+#undef INSTR_ADDR
+#undef TRACING_CHANGED
+#undef HALT
+#undef STORED
+#undef TOUCHED
+}
+
+// Profiling variant of vm_run_untraced: also counts, in vm->profile
+// (vm -P), how often each text address runs and how often each
+// conditional branch there is taken, follows calls and returns in
+// vm->callgraph (vm --callgraph), counts memory accesses in
+// vm->memprof (vm -M), and samples host counters around single
+// instructions for vm->host_counters (vm --host-opcodes). Stops where
+// vm_run_untraced does.
+uint64_t vm_run_profiled(VM *vm, uint64_t max_steps) {
+    decoded_instr_t slow;
+    const decoded_instr_t *d;
+    pc_profile *profile = vm->profile;
+    call_profile *callgraph = vm->callgraph;
+    mem_profile *memprof = vm->memprof;
+    host_counters *host = vm->host_counters;
+    bool sampled;
+    uint32_t pc = vm->pc;
+    volatile uint32_t addr = pc;
+    volatile uint64_t steps = 0;
+    int32_t t, s;
+    vm_frame frame = {&addr, &steps, NULL, vm->frame};
+    vm->frame = &frame;
+
+#define OP(h) case h:
+#define NEXT break
+#define PC pc
+#define INSTR_ADDR addr
+#define TRACING_CHANGED() goto done
+#define HALT() goto done
+#define STORED(a) do { \
+        VM_MARK_DIRTY(vm, a); \
+        if ((uint32_t) (a) < (uint32_t) vm->program_size) vm_text_written(vm, a); \
+    } while (0)
+#define TOUCHED(a)
+    while (steps < max_steps) {
+        addr = pc;
+        steps++;
+        if (addr < (uint32_t) vm->program_size) {
+            d = &vm->code[addr];
+            //Counted before it runs, since EXIT and faults leave through HALT.
+            if (profile) {
+                profile->counts[addr]++;
+            }
+        } else {
+            vm_decode(vm->memory->instrs[addr], addr, &slow);
+            d = &slow;
+            if (profile) {
+                profile->outside++;
+            }
+        }
+        if (callgraph) {
+            callgraph_count(callgraph);
+        }
+        if (memprof) {
+            memprof_step(memprof, vm, d);
+        }
+        pc = addr + 1;
+        sampled = host_sample_due(host);
+        if (sampled) {
+            host_sample_begin(host);
+        }
+        switch (d->handler) {
+#include "vm_ops.inc"
+        }
+        if (sampled) {
+            host_sample_end(host, d->handler);
+        }
+        if (profile && PROFILE_IS_BRANCH(d->handler) && pc != addr + 1) {
+            profile->taken[addr]++;
+        }
+        if (callgraph && CALLGRAPH_IS_TRANSFER(d->handler)) {
+            callgraph_transfer(callgraph, d->handler, addr, pc);
+        }
+    }
+done:
+    vm->pc = pc;
+    vm->frame = frame.outer;
+    return steps;
+#undef OP
+#undef NEXT
+#undef PC
+#undef INSTR_ADDR
+#undef TRACING_CHANGED
+#undef HALT
+#undef STORED
+#undef TOUCHED
+}
+
+#ifdef VM_THREADED
+// Direct-threaded execution engine: each handler jumps straight to the
+// next instruction's handler through the threaded_code table, using GCC's
+// labels-as-values, so there is no central switch.
+// Runs at most max_steps instructions and returns the number executed.
+// Returns early when STRA turns tracing on so the caller can trace step by step,
+// and when EXIT or a fault stops the machine.
+uint64_t vm_run_threaded(VM *vm, uint64_t max_steps) {
+#define HANDLER_LABEL(h) [h] = &&L_##h,
+    static const void *const labels[NUM_HANDLERS] = {
+        HANDLER_LIST(HANDLER_LABEL)
+    };
+#undef HANDLER_LABEL
+
+    if (!vm->threaded_code) {
+        vm->threaded_code = malloc((vm->program_size > 0 ? vm->program_size : 1) * sizeof(void *));
+        if (!vm->threaded_code) {
+            perror("Error allocating threaded code");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < vm->program_size; i++) {
+            vm->threaded_code[i] = labels[vm->code[i].fused];
+        }
+    }
+
+    const void **thread = vm->threaded_code;
+    const decoded_instr_t *code = vm->code;
+    const uint32_t size = vm->program_size;
+    const decoded_instr_t *d;
+    volatile uint32_t addr = vm->pc;
+    uint32_t pc = vm->pc;
+    volatile uint64_t steps = 0;
+    int32_t t, s;
+    vm_frame frame = {&addr, &steps, NULL, vm->frame};
+    vm->frame = &frame;
+
+#define OP(h) L_##h:
+#define NEXT do { \
+        if (max_steps - steps < 2 || pc >= size) goto slow; \
+        addr = pc; \
+        d = &code[addr]; \
+        pc = addr + 1; \
+        steps++; \
+        goto *thread[addr]; \
+    } while (0)
+#define PC pc
+#define INSTR_ADDR addr
+#define TRACING_CHANGED() goto done
+#define HALT() goto done
+#define STORED(a) do { \
+        VM_MARK_DIRTY(vm, a); \
+        if ((uint32_t) (a) < size) { \
+            vm_text_written(vm, a); \
+            goto done; \
+        } \
+    } while (0)
+#define TOUCHED(a)
+#define THEN(h) do { \
+        addr++; \
+        d = &code[addr]; \
+        pc = addr + 1; \
+        steps++; \
+        goto L_##h; \
+    } while (0)
+
+    NEXT;
+#include "vm_ops.inc"
+#include "vm_fused.inc"
+
+slow:
+    //Instructions outside the text section, and the last step of the budget
+    //(where a superinstruction could overshoot it), go through vm_run_untraced.
+    if (steps >= max_steps) {
+        goto done;
+    }
+    vm->pc = pc;
+    steps += vm_run_untraced(vm, 1);
+    pc = vm->pc;
+    if (vm->tracing || vm->state != VM_RUNNING || vm->threaded_code != thread) {
+        goto done;
+    }
+    NEXT;
+
+done:
+    vm->pc = pc;
+    vm->frame = frame.outer;
+    return steps;
+#undef OP
+#undef NEXT
+#undef PC
+#undef INSTR_ADDR
+#undef TRACING_CHANGED
+#undef HALT
+#undef STORED
+#undef TOUCHED
+#undef THEN
+}
+#endif
+
+// Allocate the block cache, on first use by vm_run_blocks or vm_run_jit
+static struct block **vm_block_cache(VM *vm) {
+    if (!vm->blocks) {
+        vm->blocks = calloc(vm->program_size > 0 ? vm->program_size : 1, sizeof(struct block *));
+        if (!vm->blocks) {
+            perror("Error allocating block cache");
+            exit(EXIT_FAILURE);
+        }
+    }
+    return vm->blocks;
+}
+
+// Block cache execution engine: runs whole cached basic blocks, and only
+// checks the step budget once per block. STRA, EXIT, faults and stores into
+// the text leave from inside the block, so nothing else is checked between
+// blocks. The counters the sandbox reads (see vm_frame) are only ever
+// stored to: the address of each instruction, and once per block its first
+// address and the steps before it.
+// This is not a speed-up over vm_run_untraced: the per-block lookup and
+// budget check cost about what they save, and on the short blocks of
+// branchy code it is up to a fifth slower. THREADED_ENGINE is the fast one.
+// Runs at most max_steps instructions and returns the number executed.
+// Returns early when STRA turns tracing on, and when EXIT or a fault
+// stops the machine.
+uint64_t vm_run_blocks(VM *vm, uint64_t max_steps) {
+    struct block **blocks = vm_block_cache(vm);
+    const uint32_t size = vm->program_size;
+    struct block *b = NULL;
+    const decoded_instr_t *d, *end;
+    uint32_t pc = vm->pc;
+    uint32_t addr = pc;
+    uint64_t steps = 0;
+    int32_t t, s;
+    volatile uint32_t at = pc;
+    volatile uint32_t first = pc;
+    volatile uint64_t done = 0;
+    vm_frame frame = {&at, &done, &first, vm->frame};
+    vm->frame = &frame;
+
+#define OP(h) case h:
+#define NEXT break
+#define PC pc
+#define INSTR_ADDR addr
+#define TRACING_CHANGED() goto stopped
+#define HALT() goto stopped
+#define STORED(a) do { \
+        VM_MARK_DIRTY(vm, a); \
+        if ((uint32_t) (a) < size) { \
+            vm_text_written(vm, a); \
+            goto stopped; \
+        } \
+    } while (0)
+#define TOUCHED(a)
+
+    while (steps < max_steps) {
+        b = pc < size ? (blocks[pc] ? blocks[pc] : vm_block_at(vm, pc)) : NULL;
+        if (!b || (uint64_t) b->length > max_steps - steps) {
+            //Code outside the text section, and blocks longer than what is left
+            //of the budget, run one instruction at a time on vm_run_untraced.
+            vm->pc = pc;
+            done = steps;
+            steps += vm_run_untraced(vm, 1);
+            pc = vm->pc;
+            if (vm->tracing || vm->state != VM_RUNNING) {
+                break;
+            }
+            continue;
+        }
+        done = steps;
+        first = pc;
+        end = b->code + b->length;
+        for (d = b->code; d < end; d++) {
+            at = addr = pc;
+            pc = addr + 1;
+            switch (d->handler) {
+#include "vm_ops.inc"
+            }
+        }
+        steps += b->length;
+    }
+    vm->pc = pc;
+    vm->frame = frame.outer;
+    return steps;
+
+stopped:
+    //STRA or EXIT ended the block, or a fault or a store into the text
+    //ended it early (and the store may have freed it).
+    vm->pc = pc;
+    vm->frame = frame.outer;
+    return steps + (addr - first) + 1;
+#undef OP
+#undef NEXT
+#undef PC
+#undef INSTR_ADDR
+#undef TRACING_CHANGED
+#undef HALT
+#undef STORED
+#undef TOUCHED
+}
+
+#ifdef VM_JIT
+// JIT engine: runs cached basic blocks as vm_run_blocks does, but compiles
+// each block to native code once it has been entered jit_threshold times
+// (see jit.c). Blocks not compiled (yet), and the instructions the native
+// code leaves to the interpreter, run on vm_run_untraced.
+// Returns as vm_run_blocks does.
+uint64_t vm_run_jit(VM *vm, uint64_t max_steps) {
+    if (!vm->jit) {
+        vm->jit = jit_create();
+    }
+    struct block **blocks = vm_block_cache(vm);
+    const uint32_t size = vm->program_size;
+    uint32_t pc = vm->pc;
+    uint64_t steps = 0;
+    volatile uint64_t done = 0;
+    vm_frame frame = {NULL, &done, NULL, vm->frame};
+    vm->frame = &frame;
+
+    while (steps < max_steps) {
+        struct block *b = pc < size ? (blocks[pc] ? blocks[pc] : vm_block_at(vm, pc)) : NULL;
+        uint64_t n = 1;
+        if (b && (uint64_t) b->length <= max_steps - steps) {
+            if (!b->native && !b->no_native && ++b->entries >= vm->jit_threshold) {
+                b->native = jit_compile(vm->jit, b->code, b->length, b->start, size);
+                b->no_native = !b->native;
+            }
+            if (b->native) {
+                uint64_t retired;
+                done = steps;
+                uint64_t next = b->native(vm, vm->memory->words, max_steps - steps, &retired);
+                steps += retired;
+                pc = (uint32_t) next;
+                if (!(next & JIT_SIDE_EXIT)) {
+                    continue;
+                }
+                //The native code stopped before an instruction it leaves to
+                //vm_run_untraced.
+            } else {
+                n = b->length;
+            }
+        }
+        vm->pc = pc;
+        done = steps;
+        steps += vm_run_untraced(vm, n);
+        pc = vm->pc;
+        if (vm->tracing || vm->state != VM_RUNNING) {
+            break;
+        }
+    }
+    vm->pc = pc;
+    vm->frame = frame.outer;
+    return steps;
+}
+#endif
+
+// Run until EXIT, a fault, or max_steps instructions have been retired,
+// printing the trace after each instruction while tracing is on (or
+// recording it in vm->trace_bin).
+vm_status_t vm_execute(VM *vm, uint64_t max_steps) {
+    volatile uint64_t steps = 0;
+    vm_frame frame = {NULL, &steps, NULL, vm->frame};
+    sigjmp_buf catch_fault;
+    if (vm->sandbox) {
+        if (sigsetjmp(catch_fault, 1)) {
+            //The sandbox stopped the machine at a stray access (see sandbox.c).
+            steps = vm->fault_steps;
+            goto stopped;
+        }
+        vm_sandbox_arm(vm, &catch_fault);
+    }
+    vm->frame = &frame;
+    while (vm->state == VM_RUNNING && steps < max_steps) {
+        bool traced = vm->tracing || vm->ngrams;
+        bool was_tracing = vm->tracing;
+        bool sampled = false;
+        handler_type sampled_op = NOP_H;
+        if ((vm->profile || vm->callgraph || vm->memprof || vm->host_counters) && !traced) {
+            steps += vm_run_profiled(vm, max_steps - steps);
+        } else
+#ifdef VM_THREADED
+        if (vm->engine == THREADED_ENGINE && !traced) {
+            steps += vm_run_threaded(vm, max_steps - steps);
+        } else
+#endif
+#ifdef VM_JIT
+        if (vm->engine == JIT_ENGINE && !traced) {
+            steps += vm_run_jit(vm, max_steps - steps);
+        } else
+#endif
+        if ((vm->engine == BLOCK_ENGINE || vm->engine == JIT_ENGINE) && !traced) {
+            steps += vm_run_blocks(vm, max_steps - steps);
+        } else if (!traced) {
+            steps += vm_run_untraced(vm, max_steps - steps);
+        } else {
+            //A traced step's sample includes the trace it prints
+            sampled = host_sample_due(vm->host_counters);
+            if (sampled) {
+                sampled_op = vm_handler_at(vm, vm->pc);
+                host_sample_begin(vm->host_counters);
+            }
+            if (vm->tracing && vm->trace_bin) {
+                trace_bin_step(vm->trace_bin, vm);
+            } else if (vm->tracing) {
+                print_instruction(vm, vm->pc);
+            }
+            if (vm->ngrams) {
+                ngram_record(vm->ngrams, vm->pc, vm_handler_at(vm, vm->pc));
+            }
+            int32_t addr = vm->pc;
+            handler_type h = vm->profile || vm->callgraph ? vm_handler_at(vm, addr) : NOP_H;
+            if (vm->memprof) {
+                decoded_instr_t slow;
+                memprof_step(vm->memprof, vm, vm_decoded_at(vm, addr, &slow));
+            }
+            vm_run(vm, addr);
+            steps++;
+            if (vm->profile) {
+                profile_record(vm->profile, addr, h, vm->pc);
+            }
+            if (vm->callgraph) {
+                callgraph_record(vm->callgraph, h, addr, vm->pc);
+            }
+            if (was_tracing && vm->trace_bin) {
+                trace_bin_end(vm->trace_bin, vm, vm->tracing && vm->state == VM_RUNNING);
+            }
+        }
+        if (vm->tracing && vm->state == VM_RUNNING) {
+            if (!vm->trace_bin) {
+                print_registers(vm);
+                print_words(vm);
+            } else if (!was_tracing) {
+                trace_bin_sync(vm->trace_bin, vm);
+            }
+        }
+        if (sampled) {
+            host_sample_end(vm->host_counters, sampled_op);
+        }
+    }
+
+stopped:
+    vm->frame = frame.outer;
+    if (vm->sandbox) {
+        vm_sandbox_disarm();
+    }
+    //Once the machine stops (EXIT or a fault), its output goes all the way out
+    if (vm->state == VM_RUNNING) {
+        trace_flush(vm->trace);
+    } else {
+        guest_output_flush(vm->trace);
+    }
+
+    vm_status_t status;
+    status.state = vm->state;
+    status.exit_code = vm->exit_code;
+    //The faulting instruction was started but not retired (unless the VM
+    //had already faulted when this was called, and nothing started).
+    status.steps = vm->state == VM_FAULTED && steps > 0 ? steps - 1 : steps;
+    vm->retired += status.steps;
+    status.fault_pc = vm->fault_pc;
+    status.fault_msg = vm->fault_msg;
+    return status;
+}
@@ -1,38 +1,215 @@
-#ifndef VM_H
-#define VM_H
-
-#include <stdint.h>
-#include "../provided/machine_types.h"
-#include "../provided/instruction.h"
-#include "../provided/regname.h"
-
-// Word size
-#define WORD_IN_BITS 32
-
-#define MEMORY_SIZE_IN_WORDS 32768
-
-// Define the structure of the VM
-typedef struct {
-    BOFHeader bf_header;        // Loaded BOF Header
-    int32_t words_index[MEMORY_SIZE_IN_WORDS]; 
-    int32_t pc;
-    int32_t HI;
-    int32_t LO;
-    int32_t registers[NUM_REGISTERS]; 
-    int32_t ip;                 // Instruction pointer
-    int32_t program[MEMORY_SIZE_IN_WORDS]; // Program memory (loaded instructions)
-    int32_t program_size;       // Size of the loaded program
-    bool tracing;               
-} VM;
-
-// Function declarations
-void vm_load_program(VM *vm, const char *filename);
-void vm_print_program(VM *vm);
-void vm_run(VM *vm, int instruction_number);
-void vm_init(VM *vm);
-void print_registers(VM *vm);
-void print_instruction(VM *vm, int instruction_number);
-void print_words(VM *vm);
-
-
-#endif // VM_H
+#ifndef VM_H
+#define VM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "../provided/machine_types.h"
+#include "../provided/instruction.h"
+#include "../provided/regname.h"
+
+// Word size
+#define WORD_IN_BITS 32
+
+// Syscall code of PINT (print an integer), which the provided
+// instruction.h leaves out of its syscall_type
+#define print_int_sc 3
+
+// Guest addresses are word indexes of up to VM_ADDRESS_BITS bits, the
+// width of a jump instruction's address field
+#define VM_ADDRESS_BITS 28
+#define VM_MAX_WORDS (1u << VM_ADDRESS_BITS)
+
+// Guest memory is reserved for the whole address space (or the smaller
+// limit set by vm_set_memory_words), and the host backs and zeroes each
+// page on first touch, so a program's footprint follows what it uses.
+// The VM keeps its own per-page state in a two-level table: VM_NUM_DIRS
+// directory entries, each covering VM_DIR_PAGES pages of VM_PAGE_WORDS
+// words (4KB).
+#define VM_PAGE_SHIFT 10
+#define VM_PAGE_WORDS (1 << VM_PAGE_SHIFT)
+#define VM_NUM_PAGES (VM_MAX_WORDS >> VM_PAGE_SHIFT)
+#define VM_DIR_SHIFT 20
+#define VM_DIR_WORDS (1 << VM_DIR_SHIFT)
+#define VM_DIR_PAGES (1 << (VM_DIR_SHIFT - VM_PAGE_SHIFT))
+#define VM_NUM_DIRS (VM_MAX_WORDS >> VM_DIR_SHIFT)
+
+// Record a store to address a in the VM's dirty-page table
+#define VM_MARK_DIRTY(vm, a) \
+    ((vm)->dirty_pages[((uint32_t) (a) >> VM_PAGE_SHIFT) & (VM_NUM_PAGES - 1)] = 1, \
+     (vm)->dirty_dirs[((uint32_t) (a) >> VM_DIR_SHIFT) & (VM_NUM_DIRS - 1)] = 1)
+
+// Alignment of the predecoded instruction image (one cache line)
+#define CODE_ALIGNMENT 64
+
+// Handlers for predecoded instructions, one per SSM operation.
+// HANDLER_LIST(X) applies X to each name, so tables indexed by handler
+// (like the threaded engine's label table) stay in step with the enum.
+#define BASE_HANDLER_LIST(X) \
+    X(NOP_H) X(ADD_H) X(SUB_H) X(CPW_H) X(AND_H) X(BOR_H) X(NOR_H) X(XOR_H) \
+    X(LWR_H) X(SWR_H) X(SCA_H) X(LWI_H) X(NEG_H) \
+    X(LIT_H) X(ARI_H) X(SRI_H) X(MUL_H) X(DIV_H) X(CFHI_H) X(CFLO_H) \
+    X(SLL_H) X(SRL_H) X(JMP_H) X(CSI_H) X(JREL_H) \
+    X(ADDI_H) X(ANDI_H) X(BORI_H) X(NORI_H) X(XORI_H) \
+    X(BEQ_H) X(BGEZ_H) X(BGTZ_H) X(BLEZ_H) X(BLTZ_H) X(BNE_H) \
+    X(JMPA_H) X(CALL_H) X(RTN_H) \
+    X(EXIT_H) X(PSTR_H) X(PINT_H) X(PCH_H) X(RCH_H) X(STRA_H) X(NOTR_H) \
+    X(ILLEGAL_H)
+
+// Superinstructions: each runs an instruction and the one after it.
+// Only the threaded engine uses them; vm_run always steps one at a time.
+#define FUSED_HANDLER_LIST(X) \
+    X(SRI_LIT_H) X(SRI_CPW_H) X(SRI_SWR_H) \
+    X(LIT_BEQ_H) X(LIT_BNE_H) X(CPW_ADD_H) X(CPW_SUB_H)
+
+#define HANDLER_LIST(X) BASE_HANDLER_LIST(X) FUSED_HANDLER_LIST(X)
+
+#define HANDLER_ENUM(h) h,
+typedef enum {
+    HANDLER_LIST(HANDLER_ENUM)
+    NUM_HANDLERS
+} handler_type;
+#undef HANDLER_ENUM
+
+#define NUM_BASE_HANDLERS (ILLEGAL_H + 1)
+
+// An instruction decoded once at load time. Register numbers and offsets
+// are pulled out of the bitfields, immediates are already sign- or
+// zero-extended, and branch/jump targets are absolute addresses.
+typedef struct {
+    uint8_t handler;            // handler_type that executes this instruction
+    uint8_t rt;                 // target register (or the only register)
+    uint8_t rs;                 // source register
+    uint8_t fused;              // superinstruction starting here, or handler if none
+    int16_t ot;                 // offset from rt
+    int16_t os;                 // offset from rs
+    int32_t imm;                // extended immediate, argument, or shift
+    int32_t target;             // absolute target of a branch or jump
+} decoded_instr_t;
+
+// Guest memory: the whole SSM address space, as words or as instructions.
+// Only the VM's memory_words words of it are mapped.
+typedef union mem_u {
+    word_type words[VM_MAX_WORDS];
+    uword_type uwords[VM_MAX_WORDS];
+    bin_instr_t instrs[VM_MAX_WORDS];
+} vm_memory;
+
+// Where a VM gets its guest memory from. alloc returns size bytes of
+// zeroed memory (or NULL on failure); release gives them back.
+typedef struct {
+    void *(*alloc)(size_t size, void *ctx);
+    void (*release)(void *mem, size_t size, void *ctx);
+    void *ctx;                  // passed to both
+} vm_allocator;
+
+// Which engine runs untraced stretches of the program
+typedef enum {SWITCH_ENGINE, THREADED_ENGINE, BLOCK_ENGINE, JIT_ENGINE} engine_type;
+
+// Whether the machine can keep running
+typedef enum {VM_RUNNING, VM_EXITED, VM_FAULTED} vm_state_type;
+
+// Result of vm_execute
+typedef struct {
+    vm_state_type state;        // VM_RUNNING if the step budget ran out
+    int32_t exit_code;          // EXIT's code, when state is VM_EXITED
+    uint64_t steps;             // instructions retired by this call
+    int32_t fault_pc;           // address of the faulting instruction
+    const char *fault_msg;      // what went wrong, when state is VM_FAULTED
+} vm_status_t;
+
+// How far an engine call has got, kept where the sandbox's SIGSEGV
+// handler can read it (see sandbox.c). The engines' own counters are
+// volatile so they are current whenever a fault interrupts them.
+typedef struct vm_frame {
+    volatile uint32_t *addr;    // instruction being executed, or NULL when fetching the one at vm->pc
+    volatile uint64_t *steps;   // instructions this call has started (or, for an outer call, finished)
+    volatile uint32_t *first;   // block engine: address of the first instruction of the current block, or NULL
+    struct vm_frame *outer;     // the call this one is nested in
+} vm_frame;
+
+// Define the structure of the VM
+typedef struct {
+    BOFHeader bf_header;        // Loaded BOF Header
+    uint64_t *touched_bits[VM_NUM_DIRS]; // words print_words lists, one bit each (a leaf per directory entry, or NULL)
+    int32_t *touched;           // the same words' addresses, in increasing order
+    int32_t num_touched;
+    int32_t touched_capacity;
+    int32_t pc;
+    int32_t HI;
+    int32_t LO;
+    int32_t registers[NUM_REGISTERS]; 
+    vm_memory *memory;          // this VM's guest memory
+    uint32_t memory_words;      // words of memory mapped (a multiple of VM_PAGE_WORDS)
+    uint8_t *dirty_pages;       // VM_NUM_PAGES flags: pages stored into since the last snapshot (see snapshot.c)
+    uint8_t dirty_dirs[VM_NUM_DIRS]; // directory entries with a dirty page under them
+    struct guest_input *in;     // where RCH reads from (stdin unless vm_set_input says otherwise)
+    vm_allocator allocator;     // where memory came from
+    int32_t program_size;       // Size of the loaded program
+    decoded_instr_t *code;      // Predecoded text, program_size records
+    const void **threaded_code; // Handler addresses for vm_run_threaded, built on first use
+    struct block **blocks;      // Block cache: the block entered at each text address, or NULL
+    uint32_t text_writes;       // count of stores into the text section
+    struct ngram_profile *ngrams; // opcode n-gram counts, when profiling
+    struct pc_profile *profile; // per-address execution counts (vm -P), or NULL
+    struct call_profile *callgraph; // shadow call stack and call tree (vm --callgraph), or NULL
+    struct mem_profile *memprof; // guest memory access counts (vm -M), or NULL
+    struct host_counters *host_counters; // host counts sampled per opcode (vm --host-opcodes), or NULL
+    struct trace_buffer *trace; // buffered trace output, on stdout unless vm_set_output says otherwise
+    struct trace_bin *trace_bin; // binary trace replacing the text one (vm --trace-bin), or NULL
+    char **asm_text;            // assembly form of each text word, formatted on first trace
+    struct jit_state *jit;      // native code for hot blocks, built on first use by JIT_ENGINE
+    uint32_t jit_threshold;     // block entries before JIT_ENGINE compiles a block
+    bool tracing;               
+    engine_type engine;         // engine for untraced stretches
+    bool sandbox;               // memory has guard regions; stray accesses fault (see sandbox.c)
+    vm_frame *frame;            // innermost engine call running this VM
+    uint64_t retired;           // instructions retired by earlier vm_execute calls since loading
+    uint64_t fault_steps;       // instructions started when the sandbox caught a fault
+    vm_state_type state;
+    int32_t exit_code;
+    int32_t fault_pc;
+    const char *fault_msg;
+} VM;
+
+// Function declarations
+bool vm_check_program(const BOFHeader *header, uint64_t file_bytes, uint32_t memory_words,
+                      const char *filename, char *error, size_t error_len);
+bool vm_read_program(VM *vm, const char *filename, char *error, size_t error_len);
+void vm_load_program(VM *vm, const char *filename);
+void vm_decode_text(VM *vm);
+uint64_t vm_current_step(VM *vm);
+bool vm_store_target(VM *vm, int32_t *addr);
+void vm_print_program(VM *vm);
+void vm_run(VM *vm, int instruction_number);
+uint64_t vm_run_untraced(VM *vm, uint64_t max_steps);
+uint64_t vm_run_profiled(VM *vm, uint64_t max_steps);
+vm_status_t vm_execute(VM *vm, uint64_t max_steps);
+void vm_fault(VM *vm, int32_t pc, const char *msg);
+#ifdef VM_THREADED
+uint64_t vm_run_threaded(VM *vm, uint64_t max_steps);
+#endif
+uint64_t vm_run_blocks(VM *vm, uint64_t max_steps);
+#ifdef VM_JIT
+uint64_t vm_run_jit(VM *vm, uint64_t max_steps);
+#endif
+void vm_init(VM *vm);
+void vm_init_allocator(VM *vm, const vm_allocator *allocator);
+void vm_set_memory_words(VM *vm, uint32_t words);
+void vm_free(VM *vm);
+void vm_decode(bin_instr_t instr, address_type addr, decoded_instr_t *d);
+void vm_fuse(VM *vm);
+void vm_text_written(VM *vm, int32_t addr);
+const char *vm_handler_name(handler_type h);
+void print_registers(VM *vm);
+void print_instruction(VM *vm, int instruction_number);
+const char *vm_instruction_text(VM *vm, int32_t addr);
+void print_words(VM *vm);
+void vm_touch(VM *vm, int32_t addr);
+void vm_set_output(VM *vm, FILE *out);
+void vm_set_input(VM *vm, FILE *in);
+word_type vm_get_word(VM *vm, int32_t addr);
+void vm_set_word(VM *vm, int32_t addr, word_type value);
+
+
+#endif // VM_H
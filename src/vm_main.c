@@ -1,38 +1,463 @@
-#include "vm.h"
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-
-int main(int argc, char *argv[]) {
-    if (argc < 2 || argc > 3) {
-        fprintf(stderr, "Usage: %s [-p] <program.bof>\n", argv[0]);
-        return EXIT_FAILURE;
-    }
-
-    VM vm;
-    vm_init(&vm);
-    // Check if the -p flag is present
-    if (argc == 3 && strcmp(argv[1], "-p") == 0) {
-        vm_load_program(&vm, argv[2]);
-        vm_print_program(&vm);
-    } else if (argc == 2) {
-        vm_load_program(&vm, argv[1]);
-        print_registers(&vm);
-        print_words(&vm);
-        for (int i = 0; i < vm.program_size; i++) {
-            if(vm.tracing) {
-                print_instruction(&vm, vm.pc);
-            }
-            vm_run(&vm, vm.pc);
-            if (vm.tracing) {
-                print_registers(&vm);
-                print_words(&vm);
-            }
-        }
-    } else {
-        fprintf(stderr, "Invalid arguments.\n");
-        return EXIT_FAILURE;
-    }
-
-    return EXIT_SUCCESS;
-}
+#include "vm.h"
+#include "ngram.h"
+#include "jit.h"
+#include "trace.h"
+#include "trace_bin.h"
+#include "batch.h"
+#include "snapshot.h"
+#include "checkpoint.h"
+#include "debugger.h"
+#include "guest_io.h"
+#include "sandbox.h"
+#include "profile.h"
+#include "callgraph.h"
+#include "memprof.h"
+#include "hostperf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// How many sequences the -n profile lists
+#define NGRAM_REPORT_TOP 20
+
+// How many addresses the -P profile lists as hottest
+#define PROFILE_REPORT_TOP 20
+
+// How many routines the --callgraph report lists
+#define CALLGRAPH_REPORT_TOP 20
+
+// How many words the -M profile lists as hottest
+#define MEMPROF_REPORT_TOP 20
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-p] <program.bof>\n", prog);
+    fprintf(stderr, "       %s [-n] [-P] [-M] [--callgraph FILE [--symbols FILE]]\n"
+            "          [--host-counters | --host-opcodes] [-q | --trace-bin FILE] [-b%s%s] <program.bof>\n", prog,
+#ifdef VM_THREADED
+            " | -t"
+#else
+            ""
+#endif
+            ,
+#ifdef VM_JIT
+            " | -j | -J"
+#else
+            ""
+#endif
+            );
+    fprintf(stderr, "       %s [-q] [-b | -t | -j | -J] --batch [--workers N] [--quantum N]\n"
+            "          [--manifest FILE] [<program.bof> ...]\n", prog);
+    fprintf(stderr, "       %s [-q] [-b | -t | -j | -J] --inputs FILE <program.bof>\n", prog);
+    fprintf(stderr, "       %s [options] [--checkpoint-every N [--checkpoint FILE]] --restore FILE\n", prog);
+    fprintf(stderr, "       %s [options] [--record FILE | --replay FILE] <program.bof>\n", prog);
+    fprintf(stderr, "       %s [--snapshot-every N] [--replay FILE] --debug <program.bof>\n", prog);
+    fprintf(stderr, "  -p  print the program listing\n");
+#ifdef VM_THREADED
+    fprintf(stderr, "  -t  run untraced stretches on the direct-threaded engine\n");
+#endif
+    fprintf(stderr, "  -b  run untraced stretches on the basic-block cache engine\n");
+#ifdef VM_JIT
+    fprintf(stderr, "  -j  like -b, compiling hot blocks to native code\n");
+    fprintf(stderr, "  -J  like -j, compiling every block the first time it runs\n");
+#endif
+    fprintf(stderr, "  -q  start with tracing off; print only the final state\n");
+    fprintf(stderr, "  --trace-bin FILE  write the trace to FILE in binary (decode it with ssm-trace)\n");
+    fprintf(stderr, "  -n  count opcode bigrams and trigrams, report them on stderr\n");
+    fprintf(stderr, "  -P  count how often each instruction runs; print an annotated listing on stderr\n");
+    fprintf(stderr, "  -M  count reads and writes of guest memory; report a heatmap, reuse distances\n"
+            "      and the hottest words on stderr\n");
+    fprintf(stderr, "  --callgraph FILE  follow CALL/CSI/RTN; write folded call stacks to FILE (for flame\n"
+            "                    graphs) and report inclusive/exclusive counts per routine on stderr\n");
+    fprintf(stderr, "  --host-counters  count host cycles, instructions, branch and L1D misses (perf_event_open)\n"
+            "                   while the program runs; report them per guest instruction on stderr\n");
+    fprintf(stderr, "  --host-opcodes  like --host-counters, also sampling 1 in %d instructions to attribute\n"
+            "                  host costs to opcodes (untraced stretches run on the switch engine)\n",
+            HOST_SAMPLE_PERIOD);
+    fprintf(stderr, "  --symbols FILE  name routines with the labels in FILE (the output of asm -s)\n");
+    fprintf(stderr, "  --batch  run many programs on a pool of threads, printing their outputs in order\n");
+    fprintf(stderr, "  --workers N  batch worker threads (default: one per CPU)\n");
+    fprintf(stderr, "  --quantum N  instructions a batch program runs before others get a turn (default %d)\n",
+            BATCH_QUANTUM);
+    fprintf(stderr, "  --manifest FILE  also run the programs listed in FILE, one per line\n");
+    fprintf(stderr, "  --inputs FILE  load the program once, then run it on each input file listed in FILE\n"
+            "                 (input logs from --record are replayed)\n");
+    fprintf(stderr, "  --sandbox  put guard regions around guest memory; a stray access is a guest fault\n");
+    fprintf(stderr, "  --memory N  give the guest N words of memory (default %u, the whole address space)\n",
+            VM_MAX_WORDS);
+    fprintf(stderr, "  --checkpoint-every N  save the running machine every N instructions, to the\n"
+            "                        --checkpoint file (default: the program's name plus .ckpt,\n"
+            "                        or the --restore file)\n");
+    fprintf(stderr, "  --restore FILE  carry on from a checkpoint instead of loading a program\n"
+            "                  (guest input is read on from stdin; it isn't saved)\n");
+    fprintf(stderr, "  --record FILE  log every byte the program reads, with the step it was read at, to FILE\n");
+    fprintf(stderr, "  --replay FILE  take the program's input from a --record log instead of stdin; reading\n"
+            "                 at a step the log has no read for is a fault\n");
+    fprintf(stderr, "  --debug  run the program under commands from stdin that step it forward and back\n"
+            "           (type help); guest input comes from the --replay log, or is empty\n");
+    fprintf(stderr, "  --snapshot-every N  steps between the debugger's snapshots, the most any command\n"
+            "                      runs again (default %d)\n", DEBUG_SNAPSHOT_INTERVAL);
+}
+
+// Run vm to the end, saving it to filename every interval instructions.
+// It had run steps instructions before; the status counts those run here.
+static vm_status_t run_checkpointed(VM *vm, uint64_t interval, const char *filename, uint64_t steps) {
+    vm_status_t status;
+    uint64_t run = 0;
+    for (;;) {
+        status = vm_execute(vm, interval);
+        run += status.steps;
+        if (status.state != VM_RUNNING) {
+            break;
+        }
+        //A restored run won't print again what was printed before the checkpoint
+        guest_output_flush(vm->trace);
+        vm_checkpoint_write(vm, steps + run, filename);
+    }
+    status.steps = run;
+    return status;
+}
+
+// Run the program loaded in vm once for each input file listed in the
+// manifest inputs, with RCH reading that file. Each run starts from a
+// snapshot taken after loading and prints what a separate vm run would.
+// An input that is a --record log is replayed rather than read.
+// Returns EXIT_FAILURE if an input can't be opened or a run faults.
+static int run_inputs(VM *vm, const char *inputs, bool quiet) {
+    int num_inputs;
+    char **input_files = batch_read_manifest(inputs, &num_inputs);
+    vm_snapshot *snap = vm_snapshot_take(vm);
+    int result = EXIT_SUCCESS;
+    for (int i = 0; i < num_inputs; i++) {
+        FILE *in = fopen(input_files[i], "rb");
+        if (!in) {
+            perror(input_files[i]);
+            result = EXIT_FAILURE;
+            continue;
+        }
+        vm_snapshot_restore(vm, snap);
+        vm_set_input(vm, in);
+        guest_input_replay(vm->in, input_files[i], vm->retired);
+        if (quiet) {
+            vm->tracing = false;
+        } else {
+            print_registers(vm);
+            print_words(vm);
+        }
+        vm_status_t status = vm_execute(vm, UINT64_MAX);
+        if (quiet) {
+            print_registers(vm);
+            print_words(vm);
+            trace_flush(vm->trace);
+            printf("%llu instructions\n", (unsigned long long) status.steps);
+        }
+        vm_set_input(vm, stdin);
+        fclose(in);
+        if (status.state == VM_FAULTED) {
+            fflush(stdout);
+            fprintf(stderr, "%s: %s at address %d (after %llu instructions)\n", input_files[i],
+                    status.fault_msg, status.fault_pc, (unsigned long long) status.steps);
+            result = EXIT_FAILURE;
+        }
+        free(input_files[i]);
+    }
+    free(input_files);
+    vm_snapshot_free(snap);
+    vm_free(vm);
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    bool listing = false;
+    engine_type engine = SWITCH_ENGINE;
+    bool ngrams = false;
+    bool profile = false;
+    bool memprof = false;
+    bool host = false;
+    uint32_t host_sample_period = 0;
+    const char *callgraph_file = NULL;
+    const char *symbols_file = NULL;
+    bool quiet = false;
+    const char *trace_bin_file = NULL;
+    uint32_t jit_threshold = JIT_THRESHOLD;
+    bool batch = false;
+    int workers = 0;
+    unsigned long long quantum = BATCH_QUANTUM;
+    const char *manifest = NULL;
+    const char *inputs = NULL;
+    unsigned long long memory_words = VM_MAX_WORDS;
+    bool sandbox = false;
+    unsigned long long checkpoint_every = 0;
+    const char *checkpoint_file = NULL;
+    const char *restore_file = NULL;
+    const char *record_file = NULL;
+    const char *replay_file = NULL;
+    bool debug = false;
+    unsigned long long snapshot_every = DEBUG_SNAPSHOT_INTERVAL;
+    int argi;
+    for (argi = 1; argi < argc && argv[argi][0] == '-'; argi++) {
+        if (strcmp(argv[argi], "-p") == 0) {
+            listing = true;
+#ifdef VM_THREADED
+        } else if (strcmp(argv[argi], "-t") == 0) {
+            engine = THREADED_ENGINE;
+#endif
+        } else if (strcmp(argv[argi], "-b") == 0) {
+            engine = BLOCK_ENGINE;
+#ifdef VM_JIT
+        } else if (strcmp(argv[argi], "-j") == 0) {
+            engine = JIT_ENGINE;
+        } else if (strcmp(argv[argi], "-J") == 0) {
+            engine = JIT_ENGINE;
+            jit_threshold = 1;
+#endif
+        } else if (strcmp(argv[argi], "-q") == 0) {
+            quiet = true;
+        } else if (strcmp(argv[argi], "--trace-bin") == 0 && argi + 1 < argc) {
+            trace_bin_file = argv[++argi];
+        } else if (strcmp(argv[argi], "--batch") == 0) {
+            batch = true;
+        } else if (strcmp(argv[argi], "--workers") == 0 && argi + 1 < argc) {
+            workers = atoi(argv[++argi]);
+        } else if (strcmp(argv[argi], "--quantum") == 0 && argi + 1 < argc) {
+            quantum = strtoull(argv[++argi], NULL, 10);
+        } else if (strcmp(argv[argi], "--manifest") == 0 && argi + 1 < argc) {
+            manifest = argv[++argi];
+        } else if (strcmp(argv[argi], "--inputs") == 0 && argi + 1 < argc) {
+            inputs = argv[++argi];
+        } else if (strcmp(argv[argi], "--sandbox") == 0) {
+            sandbox = true;
+        } else if (strcmp(argv[argi], "--memory") == 0 && argi + 1 < argc) {
+            memory_words = strtoull(argv[++argi], NULL, 0);
+        } else if (strcmp(argv[argi], "--checkpoint-every") == 0 && argi + 1 < argc) {
+            checkpoint_every = strtoull(argv[++argi], NULL, 10);
+            if (checkpoint_every == 0) {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[argi], "--checkpoint") == 0 && argi + 1 < argc) {
+            checkpoint_file = argv[++argi];
+        } else if (strcmp(argv[argi], "--restore") == 0 && argi + 1 < argc) {
+            restore_file = argv[++argi];
+        } else if (strcmp(argv[argi], "--record") == 0 && argi + 1 < argc) {
+            record_file = argv[++argi];
+        } else if (strcmp(argv[argi], "--replay") == 0 && argi + 1 < argc) {
+            replay_file = argv[++argi];
+        } else if (strcmp(argv[argi], "--debug") == 0) {
+            debug = true;
+        } else if (strcmp(argv[argi], "--snapshot-every") == 0 && argi + 1 < argc) {
+            snapshot_every = strtoull(argv[++argi], NULL, 10);
+            if (snapshot_every == 0) {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[argi], "-n") == 0) {
+            ngrams = true;
+        } else if (strcmp(argv[argi], "-P") == 0) {
+            profile = true;
+        } else if (strcmp(argv[argi], "-M") == 0) {
+            memprof = true;
+        } else if (strcmp(argv[argi], "--host-counters") == 0) {
+            host = true;
+        } else if (strcmp(argv[argi], "--host-opcodes") == 0) {
+            host = true;
+            host_sample_period = HOST_SAMPLE_PERIOD;
+        } else if (strcmp(argv[argi], "--callgraph") == 0 && argi + 1 < argc) {
+            callgraph_file = argv[++argi];
+        } else if (strcmp(argv[argi], "--symbols") == 0 && argi + 1 < argc) {
+            symbols_file = argv[++argi];
+        } else {
+            fprintf(stderr, "Invalid arguments.\n");
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (memory_words == 0 || memory_words > VM_MAX_WORDS) {
+        fprintf(stderr, "--memory must be 1 to %u words.\n", VM_MAX_WORDS);
+        return EXIT_FAILURE;
+    }
+    if (batch) {
+        if (listing || ngrams || profile || memprof || host || callgraph_file || trace_bin_file || inputs || quantum == 0 || workers < 0
+            || checkpoint_every || checkpoint_file || restore_file || record_file || replay_file || debug
+            || (argi == argc && !manifest)) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        int num_files = argc - argi;
+        char **files = &argv[argi];
+        if (manifest) {
+            int num_listed;
+            char **listed = batch_read_manifest(manifest, &num_listed);
+            files = malloc((num_listed + num_files + 1) * sizeof(char *));
+            if (!files) {
+                perror("Error allocating batch");
+                return EXIT_FAILURE;
+            }
+            memcpy(files, listed, num_listed * sizeof(char *));
+            memcpy(files + num_listed, &argv[argi], num_files * sizeof(char *));
+            num_files += num_listed;
+            free(listed);
+        }
+        batch_options options = {engine, jit_threshold, quiet, workers, quantum, (uint32_t) memory_words, sandbox};
+        return batch_run(&options, files, num_files);
+    }
+    if (argi != argc - (restore_file ? 0 : 1)
+        || (listing && (engine != SWITCH_ENGINE || ngrams || profile || memprof || host || callgraph_file
+                        || quiet))
+        || (trace_bin_file && (listing || quiet)) || (symbols_file && !callgraph_file)
+        || (inputs && (listing || ngrams || profile || memprof || host || callgraph_file || trace_bin_file))
+        || ((checkpoint_every || restore_file) && (listing || inputs))
+        || (restore_file && trace_bin_file) || (checkpoint_file && !checkpoint_every)
+        || ((record_file || replay_file) && (listing || inputs)) || (record_file && replay_file)
+        || (debug && (listing || quiet || trace_bin_file || ngrams || profile || memprof || host || callgraph_file
+                      || inputs || checkpoint_every || record_file))) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    VM vm;
+    if (sandbox) {
+        vm_init_sandbox(&vm);
+    } else {
+        vm_init(&vm);
+    }
+    if (memory_words != VM_MAX_WORDS) {
+        vm_set_memory_words(&vm, (uint32_t) memory_words);
+    }
+    uint64_t restored_steps = 0;
+    if (restore_file) {
+        restored_steps = vm_checkpoint_restore(&vm, restore_file);
+    } else {
+        vm_load_program(&vm, argv[argi]);
+    }
+    char *default_checkpoint = NULL;
+    if (checkpoint_every && !checkpoint_file) {
+        if (restore_file) {
+            checkpoint_file = restore_file;
+        } else {
+            default_checkpoint = malloc(strlen(argv[argi]) + sizeof(".ckpt"));
+            if (!default_checkpoint) {
+                perror("Error allocating checkpoint name");
+                return EXIT_FAILURE;
+            }
+            sprintf(default_checkpoint, "%s.ckpt", argv[argi]);
+            checkpoint_file = default_checkpoint;
+        }
+    }
+    if (listing) {
+        vm_print_program(&vm);
+        vm_free(&vm);
+        return EXIT_SUCCESS;
+    }
+
+    vm.engine = engine;
+    vm.jit_threshold = jit_threshold;
+    if (inputs) {
+        return run_inputs(&vm, inputs, quiet);
+    }
+
+    if (record_file) {
+        guest_input_record(vm.in, record_file);
+    } else if (replay_file && !guest_input_replay(vm.in, replay_file, vm.retired)) {
+        fprintf(stderr, "%s: not an input log\n", replay_file);
+        vm_free(&vm);
+        return EXIT_FAILURE;
+    }
+    if (debug) {
+        int result = vm_debug(&vm, snapshot_every, stdin);
+        vm_free(&vm);
+        return result;
+    }
+    if (trace_bin_file) {
+        vm.trace_bin = trace_bin_open(trace_bin_file);
+        trace_bin_sync(vm.trace_bin, &vm);
+    } else if (quiet) {
+        vm.tracing = false;
+    } else if (!restore_file) {
+        //A restored trace goes on from the state printed last before the checkpoint
+        print_registers(&vm);
+        print_words(&vm);
+    }
+    if (ngrams) {
+        vm.ngrams = ngram_create();
+    }
+    if (profile) {
+        vm.profile = profile_create(vm.program_size);
+    }
+    if (memprof) {
+        vm.memprof = memprof_create();
+    }
+    if (callgraph_file) {
+        vm.callgraph = callgraph_create(vm.pc);
+        if (symbols_file) {
+            callgraph_load_symbols(vm.callgraph, symbols_file);
+        }
+    }
+    host_counters *counters = NULL;
+    if (host) {
+        counters = host_counters_open(host_sample_period);
+        if (host_sample_period) {
+            vm.host_counters = counters;
+        }
+        host_counters_start(counters);
+    }
+    vm_status_t status;
+    if (checkpoint_every) {
+        status = run_checkpointed(&vm, checkpoint_every, checkpoint_file, restored_steps);
+    } else {
+        status = vm_execute(&vm, UINT64_MAX);
+    }
+    status.steps += restored_steps;
+    free(default_checkpoint);
+    if (counters) {
+        host_counters_stop(counters);
+    }
+    if (quiet) {
+        print_registers(&vm);
+        print_words(&vm);
+        trace_flush(vm.trace);
+        printf("%llu instructions\n", (unsigned long long) status.steps);
+    }
+    if (vm.trace_bin) {
+        trace_bin_close(vm.trace_bin);
+        vm.trace_bin = NULL;
+    }
+    if (vm.ngrams) {
+        fflush(stdout);
+        ngram_report(vm.ngrams, stderr, NGRAM_REPORT_TOP);
+        ngram_destroy(vm.ngrams);
+        vm.ngrams = NULL;
+    }
+    if (vm.profile) {
+        fflush(stdout);
+        profile_report(vm.profile, &vm, stderr, PROFILE_REPORT_TOP);
+        profile_destroy(vm.profile);
+        vm.profile = NULL;
+    }
+    if (counters) {
+        fflush(stdout);
+        host_counters_report(counters, status.steps, stderr);
+        host_counters_close(counters);
+        vm.host_counters = NULL;
+    }
+    if (vm.memprof) {
+        fflush(stdout);
+        memprof_report(vm.memprof, &vm, stderr, MEMPROF_REPORT_TOP);
+        memprof_destroy(vm.memprof);
+        vm.memprof = NULL;
+    }
+    if (vm.callgraph) {
+        fflush(stdout);
+        callgraph_write_folded(vm.callgraph, callgraph_file);
+        callgraph_report(vm.callgraph, stderr, CALLGRAPH_REPORT_TOP);
+        callgraph_destroy(vm.callgraph);
+        vm.callgraph = NULL;
+    }
+    vm_free(&vm);
+    if (status.state == VM_FAULTED) {
+        fflush(stdout);
+        fprintf(stderr, "%s at address %d (after %llu instructions)\n",
+                status.fault_msg, status.fault_pc, (unsigned long long) status.steps);
+        return EXIT_FAILURE;
+    }
+    return status.exit_code;
+}